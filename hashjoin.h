@@ -0,0 +1,382 @@
+/*-------------------------------------------------------------------------
+ *
+ * hashjoin.h
+ *	  internal structures for hash joins
+ *
+ *
+ * Portions Copyright (c) 1996-2005, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * $PostgreSQL: pgsql/src/include/executor/hashjoin.h,v 1.36 2005/03/06 22:15:05 tgl Exp $
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef HASHJOIN_H
+#define HASHJOIN_H
+
+#include "access/htup.h"
+#include "access/tupdesc.h"
+#include "fmgr.h"
+#include "storage/buffile.h"
+#include "utils/relcache.h"
+
+/* ----------------------------------------------------------------
+ *				hash-join hash table structures
+ *
+ * Each active hashjoin has a HashJoinTable control block, which is
+ * palloc'd in the executor's per-query context.  All other storage needed
+ * for the hashjoin is kept in private memory contexts, two for each hashjoin.
+ * This makes it easy and fast to release the storage when we don't need it
+ * anymore.
+ *
+ * The hashtable contexts are made children of the per-query context, ensuring
+ * that they will be discarded at end of statement even if the join is
+ * aborted early by an error.  (Likewise, any temporary files we make will
+ * be cleaned up by the virtual file manager in event of an error.)
+ *
+ * Storage that should live through the entire join is allocated from the
+ * "hashCxt", while storage that is only wanted for the current batch is
+ * allocated in the "batchCxt".  By resetting the batchCxt at the end of
+ * each batch, we free all the per-batch storage reliably and without tedium.
+ *
+ * During first scan of inner relation, we get its tuples from executor.
+ * If nbatch > 1 then tuples that don't belong in first batch get saved
+ * into inner-batch temp files. The same statements apply for the
+ * first scan of the outer relation, except we write tuples to outer-batch
+ * temp files.	After finishing the first scan, we do the following for
+ * each remaining batch:
+ *	1. Read tuples from inner batch file, load into hash buckets.
+ *	2. Read tuples from outer batch file, match to hash buckets and output.
+ *
+ * It is possible to increase nbatch on the fly if the in-memory hash table
+ * gets too big.  The hash-value-to-batch computation is arranged so that this
+ * can only cause a tuple to go into a later batch than previously thought,
+ * never into an earlier batch.  When we increase nbatch, we rescan the hash
+ * table and dump out any tuples that are now of a later batch to the correct
+ * inner batch file.  Subsequently, while reading either inner or outer batch
+ * files, we might find tuples that no longer belong to the current batch;
+ * if so, we just dump them out to the correct batch file.
+ *
+ * CSI3130: the symmetric hash join keeps one of these tables for each of its
+ * two inputs.  Each input's tuples are inserted into its own table and probe
+ * the other one.  The two tables are partners (see ExecHashTableLink): they
+ * split their inputs into the same batches, and a table whose memory fills
+ * up flushes one or more of its batches to their files (see
+ * ExecHashFlushBatches).  The partner keeps its side of such a batch in
+ * memory, for the table's later tuples to probe, but adds no more tuples
+ * to it.  A table's unjoinedBatchFile[i] then holds its input's batch-i
+ * tuples that haven't joined with anything yet, and its joinedBatchFile[i]
+ * those that have joined with all of the other table's batch-i tuples in
+ * memory (marked "joined", so that no such pair is produced again).  Once
+ * both inputs are exhausted, the remaining batches are joined one at a
+ * time: the smaller side's files are loaded into its table and the other
+ * side's files are streamed past it.
+ * ----------------------------------------------------------------
+ */
+
+/* these are in nodes/execnodes.h: */
+/* typedef struct HashJoinTupleData *HashJoinTuple; */
+/* typedef struct HashJoinTableData *HashJoinTable; */
+
+typedef struct HashJoinTupleData
+{
+	struct HashJoinTupleData *next;		/* link to next tuple in same bucket */
+	uint32		hashvalue;		/* tuple's hash code */
+	bool		joined;			/* already joined with other side's memory? */
+	HeapTupleData htup;			/* tuple header */
+} HashJoinTupleData;
+
+/*
+ * Batch files.  Tuples spilled to a batch are packed into blocks of about
+ * HJ_SPILL_BLOCK_SIZE bytes.  Each tuple is stored as its hash value,
+ * length, t_self and t_tableOid, followed by its data; a block starts with
+ * a header giving its tuple count, lengths and a CRC of its contents, and
+ * its tuples are compressed with pglz if hashjoin_spill_compression was on
+ * when the file was created and that makes the block smaller.  buf holds
+ * the block being filled or, once the file has been rewound for reading,
+ * the block being read back, whose tuples are handed out in place through
+ * the tuple header.  (See ExecHashBatchFileWrite.)  Each file's I/O is
+ * counted in its table's spillStats; under EXPLAIN ANALYZE, the time spent
+ * in its reads and writes is added up there too.
+ */
+typedef struct HashJoinSpillStats
+{
+	bool		timing;			/* time the reads and writes? */
+	double		blocksWritten;
+	double		bytesWritten;	/* as written, i.e. after compression */
+	double		writeTime;		/* seconds spent writing */
+	double		bytesRead;
+	double		readTime;		/* seconds spent reading */
+} HashJoinSpillStats;
+
+typedef struct HashJoinBatchFileData
+{
+	BufFile    *file;			/* buffered virtual temp file */
+	HashJoinSpillStats *stats;	/* where to count the file's I/O */
+	bool		compress;		/* compress blocks with pglz? */
+	bool		reading;		/* rewound for reading yet? */
+	char	   *buf;			/* current block's tuples, uncompressed */
+	Size		bufsize;		/* allocated size of buf */
+	Size		used;			/* # bytes of tuples in buf */
+	Size		pos;			/* read position in buf */
+	int			ntuples;		/* # tuples in buf (left to read) */
+	char	   *lzbuf;			/* compressed block, if compress */
+	HeapTupleData tuple;		/* last tuple read, pointing into buf */
+} HashJoinBatchFileData;
+
+typedef HashJoinBatchFileData *HashJoinBatchFile;
+
+#define HJ_SPILL_BLOCK_SIZE		BLCKSZ
+
+/*
+ * A tuple as stored in a batch file block (and in a checkpoint file, see
+ * nodeHashjoin.c).  Each record and the tuple data in it start MAXALIGN'ed
+ * within the block, so a tuple read back can be used right where it is in
+ * the buffer.
+ */
+typedef struct HashJoinSpillRecord
+{
+	uint32		hashvalue;		/* tuple's hash code */
+	uint32		t_len;			/* length of the tuple data */
+	ItemPointerData t_self;
+	Oid			t_tableOid;
+	/* tuple data (HeapTupleHeader and all) follows */
+} HashJoinSpillRecord;
+
+#define HJ_SPILL_RECORD_SIZE(t_len) \
+	(MAXALIGN(sizeof(HashJoinSpillRecord)) + MAXALIGN(t_len))
+
+/*
+ * Skew optimization.  When a few join key values account for a large part
+ * of an input, one chain in buckets[] ends up holding most of the table and
+ * every probe for those keys walks it.  Since either input of the symmetric
+ * join may be skewed, both tables get the same set of "skew buckets", one
+ * per most-common value (MCV) of the join key taken from the planner's
+ * statistics for either input.  Tuples whose hash
+ * value matches an MCV's hash value are kept in that skew bucket instead of
+ * the main buckets[] array, so probes for a hot key go straight to a chain
+ * holding only that key, and probes for other keys never walk the hot chain.
+ *
+ * The skew buckets are found through a small open-addressing hash table
+ * (skewBucket[], indexed by hash value) and live in batchCxt, for the first
+ * pass only.  Skew tuples are counted in spaceUsed like any others, and
+ * together with the skew hash table may take up at most skewSpaceAllowed
+ * (SKEW_WORK_MEM_PERCENT of spaceAllowed).  Beyond that, both tables give
+ * up their coldest skew bucket, and its tuples go back to the main buckets
+ * or to the batch files; skewBucketNums[] lists the active buckets hottest
+ * first for that purpose.
+ */
+typedef struct HashSkewBucket
+{
+	uint32		hashvalue;		/* common hash value */
+	HashJoinTuple tuples;		/* linked list of skew tuples */
+} HashSkewBucket;
+
+#define SKEW_BUCKET_OVERHEAD  MAXALIGN(sizeof(HashSkewBucket))
+#define INVALID_SKEW_BUCKET_NO	(-1)
+#define SKEW_WORK_MEM_PERCENT  2
+#define SKEW_MIN_FREQUENCY  0.01
+
+typedef struct HashJoinTableData
+{
+	long		nbuckets;		/* # buckets in the in-memory hash table */
+	/* buckets[i] is head of list of tuples in i'th in-memory bucket */
+	struct HashJoinTupleData **buckets;
+	/* buckets array is per-batch storage, as are all the tuples */
+
+	int			nbatch;			/* number of batches */
+	int			curbatch;		/* current batch #; 0 during 1st pass */
+
+	int			nbatch_original;	/* nbatch when we started inner scan */
+	int			nbatch_outstart;	/* nbatch when we started outer scan */
+
+	bool		growEnabled;	/* flag to shut off nbatch increases */
+
+	double		totalTuples;	/* # tuples obtained from inner plan */
+
+	/*
+	 * These arrays are allocated for the life of the hash join, but only if
+	 * nbatch > 1.	A file is opened only when we first write a tuple into it
+	 * (otherwise its pointer remains NULL).  Note that the zero'th array
+	 * elements never get used, since we will process rather than dump out
+	 * any tuples of batch zero.
+	 */
+	struct HashJoinBatchFileData **unjoinedBatchFile;	/* per batch: tuples
+														 * not joined yet */
+	struct HashJoinBatchFileData **joinedBatchFile;	/* per batch: tuples
+													 * joined in 1st pass */
+	double	   *spillBytes;		/* # bytes written to each batch's files */
+	HashJoinSpillStats spillStats;	/* I/O on all the batch files */
+
+	/*
+	 * During the first pass, every batch stays in memory until the table
+	 * runs out of room and the batch is chosen for flushing to its files.
+	 * batchResident[i] says whether batch i is still in memory,
+	 * batchSpace[i] is the number of bytes its tuples take up in buckets[],
+	 * and batchHits[i] counts the matches found among them.  All are NULL
+	 * while nbatch is 1.  Batch 0 is never flushed.
+	 */
+	bool	   *batchResident;
+	Size	   *batchSpace;
+	double	   *batchHits;
+	int			batchesFlushed;	/* # batches this table chose to flush */
+	double		flushedSpace;	/* # bytes of tuples flushed from it */
+
+	struct HashJoinTableData *partner;	/* other input's table, or NULL */
+	struct HashJoinTupleData *newestTuple;	/* last tuple put in buckets[] */
+
+	/*
+	 * Info about the datatype-specific hash functions for the datatypes being
+	 * hashed.	We assume that the inner and outer sides of each hashclause
+	 * are the same type, or at least share the same hash function. This is
+	 * an array of the same length as the number of hash keys.
+	 */
+	FmgrInfo   *hashfunctions;	/* lookup data for hash functions */
+
+	Size		spaceUsed;		/* memory space currently used by tuples */
+	Size		spaceAllowed;	/* upper limit for space used */
+
+	MemoryContext hashCxt;		/* context for whole-hash-join storage */
+	MemoryContext batchCxt;		/* context for this-batch-only storage */
+	struct HashJoinArenaData *arena;	/* mmap'd batch storage, or NULL */
+	struct HashJoinArenaData *bucketArena;	/* anonymous mapping holding
+											 * a large buckets[], or NULL */
+	Size		mmapSize;		/* size of the file to map once the table
+								 * outgrows work_mem, or 0 */
+
+	/*
+	 * Late materialization.  If lateRel isn't NULL, the hashed input is a
+	 * base-relation scan and we store only its join key columns (all other
+	 * columns are set null) plus t_self.  The full tuple is refetched from
+	 * lateRel when a match is emitted.  lateKeepAttr[i] is true if column
+	 * i+1 is referenced by a hash key; lateValues/lateNulls are workspace
+	 * for building the stripped tuples, and lateTuple holds the header of
+	 * the most recently refetched tuple.
+	 */
+	Relation	lateRel;		/* relation to refetch from, or NULL */
+	TupleDesc	lateTupDesc;	/* descriptor of the scan's tuples */
+	bool	   *lateKeepAttr;	/* per-column "is a join key" flags */
+	Datum	   *lateValues;
+	char	   *lateNulls;
+	HeapTupleData lateTuple;
+
+	/*
+	 * Blocked Bloom filter over the hash values of the tuples inserted into
+	 * the in-memory table.  Each hash value selects one block of
+	 * HJ_BLOOM_BLOCK_WORDS words (which fits in one cache line) and sets one bit in
+	 * every word of it.  Probes from the other input test the filter before
+	 * touching the buckets.  Tuples leaving the table (e.g. dumped to a later
+	 * batch) leave their bits behind, which only costs false positives.
+	 */
+	uint32	   *bloomFilter;	/* nbloomBlocks * HJ_BLOOM_BLOCK_WORDS */
+	uint32		nbloomBlocks;	/* # blocks; always a power of 2 */
+	double		bloomPassed;	/* # probes the filter let through */
+	double		bloomRejected;	/* # probes the filter rejected */
+
+	bool		skewEnabled;	/* are we using skew optimization? */
+	HashSkewBucket **skewBucket;	/* hashtable of skew buckets */
+	int			skewBucketLen;	/* size of skewBucket array (a power of 2!) */
+	int			nSkewBuckets;	/* number of active skew buckets */
+	int		   *skewBucketNums;	/* array indexes of active skew buckets */
+	Size		spaceUsedSkew;	/* skew hash table's current space usage */
+	Size		skewSpaceAllowed;	/* upper limit for skew hashtable */
+	double		skewTuples;		/* # tuples put in skew buckets */
+
+	/*
+	 * Sliding window (hashjoin_window_size > 0).  Only the windowSize most
+	 * recently inserted tuples are kept.  windowRing holds them in insertion
+	 * order, and windowNext is the slot of the oldest one, which is evicted
+	 * to make room for the next insertion once the ring is full.  Buckets
+	 * are kept oldest-first (new tuples are appended at bucketTails[i]), so
+	 * the tuple being evicted is always at the head of its bucket.
+	 */
+	int			windowSize;		/* max # tuples kept, or 0 if no window */
+	int			windowNext;		/* ring slot of the oldest tuple */
+	struct HashJoinTupleData **windowRing;
+	struct HashJoinTupleData **bucketTails;
+	double		windowEvicted;	/* # tuples evicted from the window */
+
+	double		purgedTuples;	/* # tuples removed by ExecHashTablePurge */
+
+	bool		persistent;		/* everything lives under TopMemoryContext */
+	bool		checkpointed;	/* single-batch for a checkpointed join */
+} HashJoinTableData;
+
+/*
+ * Persistent join state (hashjoin_state_name).  A hash join run under a
+ * state name leaves its two tables behind, registered under that name in a
+ * backend-local list, and the next run under the same name continues from
+ * them: its new input rows are inserted into the tables and probe the other
+ * side's, so it produces only the join rows that the new rows contribute.
+ * That is exactly the delta needed to maintain an insert-only join view.
+ *
+ * The tables live under TopMemoryContext, in one batch.  outdesc, indesc
+ * and hashoperators record what the tables were built from, so that a join
+ * of different shape doesn't pick them up.  inuse is set while a join is
+ * using the state.  changedSubid is the (sub)transaction that last claimed
+ * it; if that aborts, the tables hold rows that were never committed and
+ * are thrown away.
+ */
+typedef struct HashJoinSavedState
+{
+	char		name[NAMEDATALEN];
+	TupleDesc	outdesc;		/* row type of the outer input */
+	TupleDesc	indesc;			/* row type of the inner input */
+	List	   *hashoperators;	/* join operators of the hash clauses */
+	HashJoinTable outtable;		/* saved tables, or NULL if none yet */
+	HashJoinTable intable;
+	bool		inuse;			/* claimed by a running join? */
+	SubTransactionId changedSubid;	/* or InvalidSubTransactionId once
+									 * committed */
+	struct HashJoinSavedState *next;
+} HashJoinSavedState;
+
+/*
+ * Storage for a table's buckets and tuples in a memory-mapped temp file,
+ * which the kernel pages in and out for us (see hashjoin_mmap_mem).  It is
+ * handed out front to back and only given back as a whole, when the batch
+ * ends; whatever doesn't fit comes from batchCxt as usual, and is counted
+ * in overflow.  A large bucket
+ * array gets an anonymous mapping of its own, whose pages the kernel
+ * zeroes only when they are first touched.  Under hashjoin_huge_pages,
+ * a table's arena is an anonymous mapping too, and anonymous mappings are
+ * aligned and advised to use transparent huge pages.
+ */
+typedef struct HashJoinArenaData
+{
+	char	   *base;			/* start of the mapping */
+	Size		size;			/* its length */
+	Size		used;			/* bytes handed out in this batch */
+	Size		peak;			/* most bytes ever handed out */
+	Size		overflow;		/* bytes taken from batchCxt when full */
+	bool		hugePages;		/* kernel accepted MADV_HUGEPAGE? */
+	struct HashJoinArenaData *next;		/* next live arena, see nodeHash.c */
+} HashJoinArenaData;
+
+/*
+ * Are a table's tuples of batchno in memory?  During the first pass that's
+ * any batch the table hasn't flushed; later, only the current batch.
+ */
+#define HJ_BATCH_IN_MEMORY(hashtable, batchno) \
+	((hashtable)->curbatch > 0 ? \
+	 (batchno) == (hashtable)->curbatch : \
+	 ((hashtable)->batchResident == NULL || \
+	  (hashtable)->batchResident[batchno]))
+
+/*
+ * Do new tuples of batchno go into memory (rather than the batch files)?
+ * Only if the batch is in memory in both the table and its partner: once
+ * the partner has flushed it, the table keeps the tuples it has for the
+ * partner's new tuples to probe, but saves its own new ones to the files.
+ */
+#define HJ_BATCH_RESIDENT(hashtable, batchno) \
+	(HJ_BATCH_IN_MEMORY(hashtable, batchno) && \
+	 ((hashtable)->partner == NULL || \
+	  HJ_BATCH_IN_MEMORY((hashtable)->partner, batchno)))
+
+#define HJ_BLOOM_BLOCK_WORDS	8
+
+/* bucket number for a probe that the Bloom filter has already ruled out */
+#define HJ_NO_BUCKET			(-1)
+
+#endif   /* HASHJOIN_H */
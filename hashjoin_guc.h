@@ -0,0 +1,121 @@
+/*-------------------------------------------------------------------------
+ *
+ * hashjoin_guc.h
+ *	  guc.c table entries for the symmetric hash join's settings
+ *
+ * The settings are defined in nodeHash.c and declared in nodeHash.h.  To
+ * make them settable, guc.c includes this file and expands each macro just
+ * before the end marker of the matching table:
+ *
+ *		HASHJOIN_GUC_BOOL_ROWS		in ConfigureNamesBool[]
+ *		HASHJOIN_GUC_INT_ROWS		in ConfigureNamesInt[]
+ *		HASHJOIN_GUC_STRING_ROWS	in ConfigureNamesString[]
+ *
+ *
+ * Portions Copyright (c) 1996-2005, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef HASHJOIN_GUC_H
+#define HASHJOIN_GUC_H
+
+#include "executor/nodeHash.h"
+#include "utils/memutils.h"
+
+#define HASHJOIN_GUC_BOOL_ROWS \
+	{ \
+		{"hashjoin_spill_compression", PGC_USERSET, QUERY_TUNING_OTHER, \
+			gettext_noop("Compresses the batch files hash joins spill to disk."), \
+			gettext_noop("Saves temp file space and I/O at the cost of " \
+						 "CPU time.") \
+		}, \
+		&hashjoin_spill_compression, \
+		false, NULL, NULL \
+	}, \
+	{ \
+		{"hashjoin_huge_pages", PGC_USERSET, RESOURCES_MEM, \
+			gettext_noop("Backs large hash join tables with transparent huge pages."), \
+			gettext_noop("Cuts TLB misses on probes into large tables, where " \
+						 "the platform supports it.") \
+		}, \
+		&hashjoin_huge_pages, \
+		false, NULL, NULL \
+	},
+
+#define HASHJOIN_GUC_INT_ROWS \
+	{ \
+		{"hashjoin_window_size", PGC_USERSET, QUERY_TUNING_OTHER, \
+			gettext_noop("Sets the number of most recent rows a hash join keeps of each input."), \
+			gettext_noop("Older rows no longer produce matches. " \
+						 "Zero keeps all rows.") \
+		}, \
+		&hashjoin_window_size, \
+		0, 0, HJ_MAX_WINDOW_SIZE, NULL, NULL \
+	}, \
+	{ \
+		{"hashjoin_checkpoint_interval", PGC_USERSET, QUERY_TUNING_OTHER, \
+			gettext_noop("Sets the number of input rows a hash join reads between checkpoints."), \
+			NULL \
+		}, \
+		&hashjoin_checkpoint_interval, \
+		1000000, 1, INT_MAX, NULL, NULL \
+	}, \
+	{ \
+		{"hashjoin_mmap_mem", PGC_USERSET, RESOURCES_MEM, \
+			gettext_noop("Sets the maximum memory a hash join table may keep in a memory-mapped temp file."), \
+			gettext_noop("A table that outgrows work_mem maps a file of this " \
+						 "size instead of writing out batches. The kernel " \
+						 "writes the pages back to the file in the background, " \
+						 "so raising work_mem is cheaper where memory allows. " \
+						 "Values not above work_mem turn this off.") \
+		}, \
+		&hashjoin_mmap_mem, \
+		0, 0, INT_MAX / 1024, NULL, NULL \
+	},
+
+#define HASHJOIN_GUC_STRING_ROWS \
+	{ \
+		{"hashjoin_state_name", PGC_USERSET, QUERY_TUNING_OTHER, \
+			gettext_noop("Sets the name under which hash joins keep their state across runs."), \
+			gettext_noop("A hash join run under a state name continues from " \
+						 "the hash tables the last run under that name left, " \
+						 "and returns only the join rows of its new input rows. " \
+						 "An empty string disables this.") \
+		}, \
+		&hashjoin_state_name, \
+		"", NULL, NULL \
+	}, \
+	{ \
+		{"hashjoin_checkpoint_file", PGC_SUSET, QUERY_TUNING_OTHER, \
+			gettext_noop("Sets the file hash joins checkpoint their state to."), \
+			gettext_noop("A hash join that finds a checkpoint in this file " \
+						 "resumes from it. The name must be an absolute path. " \
+						 "An empty string disables checkpoints.") \
+		}, \
+		&hashjoin_checkpoint_file, \
+		"", NULL, NULL \
+	}, \
+	{ \
+		{"hashjoin_batch_order", PGC_USERSET, QUERY_TUNING_OTHER, \
+			gettext_noop("Sets the order in which hash joins join their spilled batches."), \
+			gettext_noop("Valid values are LARGEST, which joins the largest " \
+						 "batches first, SMALLEST, and MATCHES, which joins " \
+						 "those expected to produce the most join rows first.") \
+		}, \
+		&hashjoin_batch_order_string, \
+		"largest", assign_hashjoin_batch_order, NULL \
+	}, \
+	{ \
+		{"hashjoin_flush_policy", PGC_USERSET, QUERY_TUNING_OTHER, \
+			gettext_noop("Sets how a full hash join table picks the batches to write out."), \
+			gettext_noop("Valid values are LARGEST, which writes out the " \
+						 "largest batches, and ADAPTIVE, which writes out " \
+						 "those whose rows have found the fewest matches per " \
+						 "byte so far.") \
+		}, \
+		&hashjoin_flush_policy_string, \
+		"largest", assign_hashjoin_flush_policy, NULL \
+	},
+
+#endif   /* HASHJOIN_GUC_H */
@@ -1,904 +1,3364 @@
-/*-------------------------------------------------------------------------
- *
- * nodeHash.c
- *	  Routines to hash relations for hashjoin
- *
- * Portions Copyright (c) 1996-2005, PostgreSQL Global Development Group
- * Portions Copyright (c) 1994, Regents of the University of California
- *
- *
- * IDENTIFICATION
- *	  $PostgreSQL: pgsql/src/backend/executor/nodeHash.c,v 1.96.2.2 2005/11/23 20:28:04 tgl Exp $
- *
- *-------------------------------------------------------------------------
- */
-/*
- * INTERFACE ROUTINES
- *		MultiExecHash	- generate an in-memory hash table of the relation
- *		ExecInitHash	- initialize node and subnodes
- *		ExecEndHash		- shutdown node and subnodes
- */
-#include "postgres.h"
-
-#include "executor/execdebug.h"
-#include "executor/hashjoin.h"
-#include "executor/instrument.h"
-#include "executor/nodeHash.h"
-#include "executor/nodeHashjoin.h"
-#include "miscadmin.h"
-#include "parser/parse_expr.h"
-#include "utils/memutils.h"
-#include "utils/lsyscache.h"
-#include "../../include/nodes/execnodes.h"
-#include "../../include/executor/hashjoin.h"
-
-
-static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
-
-
-/* ----------------------------------------------------------------
- *		ExecHash
- *
- *		CHANGED for CSI3130 Project
- * ----------------------------------------------------------------
- *
- * NOTE: This is the method that has been altered for CSI3130 project
- */
-TupleTableSlot *
-ExecHash(HashState *node)
-{
-    /*
-     * CSI3130
-     */
-	PlanState *outerNode;
-    List *hashkeys;
-    HashJoinTable hashtable;
-    TupleTableSlot *slot;
-    ExprContext *econtext;
-    uint32 val;
-
-    if (node->ps.instrument){ //Instrumentation
-        InstrStartNode(node->ps.instrument);
-    }
-
-    outerNode = outerPlanState(node); //Node's StateInfo
-    hashtable = node->hashtable;
-
-    hashkeys = node->hashkeys; //Expression contextt
-    econtext = node->ps.ps_ExprContext;
-
-    slot = ExecProcNode(outerNode); //Get all tuples, insert into table
-
-
-    if(TupIsNull(slot))
-        return NULL;
-
-    hashtable->totalTuples += 1; //Compute hash val
-    econtext->ecxt_innertuple = slot;
-    econtext->ecxt_outertuple = slot;
-    val = ExecHashGetHashValue(hashtable, econtext, hashkeys);
-    ExecHashTableInsert(hashtable, ExecFetchSlotTuple(slot), val);
-
-    if (node->ps.instrument)
-        InstrStopNodeMulti(node->ps.instrument, hashtable->totalTuples);
-
-    return slot; //return tuple
-}
-
-/* ----------------------------------------------------------------
- *		MultiExecHash
- *
- *		build hash table for hashjoin, doing partitioning if more
- *		than one batch is required.
- * ----------------------------------------------------------------
- */
-Node *
-MultiExecHash(HashState *node)
-{
-	PlanState  *outerNode;
-	List	   *hashkeys;
-	HashJoinTable hashtable;
-	TupleTableSlot *slot;
-	ExprContext *econtext;
-	uint32		hashvalue;
-
-	/* must provide our own instrumentation support */
-	if (node->ps.instrument)
-		InstrStartNode(node->ps.instrument);
-
-	/*
-	 * get state info from node
-	 */
-	outerNode = outerPlanState(node);
-	hashtable = node->hashtable;
-
-	/*
-	 * set expression context
-	 */
-	hashkeys = node->hashkeys;
-	econtext = node->ps.ps_ExprContext;
-
-	/*
-	 * get all inner tuples and insert into the hash table (or temp files)
-	 */
-	for (;;)
-	{
-		slot = ExecProcNode(outerNode);
-		if (TupIsNull(slot))
-			break;
-		hashtable->totalTuples += 1;
-		/* We have to compute the hash value */
-		econtext->ecxt_innertuple = slot;
-		hashvalue = ExecHashGetHashValue(hashtable, econtext, hashkeys);
-		ExecHashTableInsert(hashtable, ExecFetchSlotTuple(slot), hashvalue);
-	}
-
-	/* must provide our own instrumentation support */
-	if (node->ps.instrument)
-		InstrStopNodeMulti(node->ps.instrument, hashtable->totalTuples);
-
-	/*
-	 * We do not return the hash table directly because it's not a subtype of
-	 * Node, and so would violate the MultiExecProcNode API.  Instead, our
-	 * parent Hashjoin node is expected to know how to fish it out of our node
-	 * state.  Ugly but not really worth cleaning up, since Hashjoin knows
-	 * quite a bit more about Hash besides that.
-	 */
-	return NULL;
-}
-
-/* ----------------------------------------------------------------
- *		ExecInitHash
- *
- *		Init routine for Hash node
- * ----------------------------------------------------------------
- */
-HashState *
-ExecInitHash(Hash *node, EState *estate)
-{
-	HashState  *hashstate;
-
-	SO_printf("ExecInitHash: initializing hash node\n");
-
-	/*
-	 * create state structure
-	 */
-	hashstate = makeNode(HashState);
-	hashstate->ps.plan = (Plan *) node;
-	hashstate->ps.state = estate;
-	hashstate->hashtable = NULL;
-	hashstate->hashkeys = NIL;	/* will be set by parent HashJoin */
-
-	/*
-	 * Miscellaneous initialization
-	 *
-	 * create expression context for node
-	 */
-	ExecAssignExprContext(estate, &hashstate->ps);
-
-#define HASH_NSLOTS 1
-
-	/*
-	 * initialize our result slot
-	 */
-	ExecInitResultTupleSlot(estate, &hashstate->ps);
-
-	/*
-	 * initialize child expressions
-	 */
-	hashstate->ps.targetlist = (List *)
-		ExecInitExpr((Expr *) node->plan.targetlist,
-					 (PlanState *) hashstate);
-	hashstate->ps.qual = (List *)
-		ExecInitExpr((Expr *) node->plan.qual,
-					 (PlanState *) hashstate);
-
-	/*
-	 * initialize child nodes
-	 */
-	outerPlanState(hashstate) = ExecInitNode(outerPlan(node), estate);
-
-	/*
-	 * initialize tuple type. no need to initialize projection info because
-	 * this node doesn't do projections
-	 */
-	ExecAssignResultTypeFromTL(&hashstate->ps);
-	hashstate->ps.ps_ProjInfo = NULL;
-
-	return hashstate;
-}
-
-int
-ExecCountSlotsHash(Hash *node)
-{
-	return ExecCountSlotsNode(outerPlan(node)) +
-		ExecCountSlotsNode(innerPlan(node)) +
-		HASH_NSLOTS;
-}
-
-/* ---------------------------------------------------------------
- *		ExecEndHash
- *
- *		clean up routine for Hash node
- * ----------------------------------------------------------------
- */
-void
-ExecEndHash(HashState *node)
-{
-	PlanState  *outerPlan;
-
-	/*
-	 * free exprcontext
-	 */
-	ExecFreeExprContext(&node->ps);
-
-	/*
-	 * shut down the subplan
-	 */
-	outerPlan = outerPlanState(node);
-	ExecEndNode(outerPlan);
-}
-
-
-/* ----------------------------------------------------------------
- *		ExecHashTableCreate
- *
- *		create an empty hashtable data structure for hashjoin.
- * ----------------------------------------------------------------
- */
-HashJoinTable
-ExecHashTableCreate(Hash *node, List *hashOperators)
-{
-	HashJoinTable hashtable;
-	Plan	   *outerNode;
-	int			nbuckets;
-	int			nbatch;
-	int			nkeys;
-	int			i;
-	ListCell   *ho;
-	MemoryContext oldcxt;
-
-	/*
-	 * Get information about the size of the relation to be hashed (it's the
-	 * "outer" subtree of this node, but the inner relation of the hashjoin).
-	 * Compute the appropriate size of the hash table.
-	 */
-	outerNode = outerPlan(node);
-
-	ExecChooseHashTableSize(outerNode->plan_rows, outerNode->plan_width,
-							&nbuckets, &nbatch);
-
-#ifdef HJDEBUG
-	printf("nbatch = %d, nbuckets = %d\n", nbatch, nbuckets);
-#endif
-
-	/*
-	 * Initialize the hash table control block.
-	 *
-	 * The hashtable control block is just palloc'd from the executor's
-	 * per-query memory context.
-	 */
-	hashtable = (HashJoinTable) palloc(sizeof(HashJoinTableData));
-	hashtable->nbuckets = nbuckets;
-	hashtable->buckets = NULL;
-	hashtable->nbatch = nbatch;
-	hashtable->curbatch = 0;
-	hashtable->nbatch_original = nbatch;
-	hashtable->nbatch_outstart = nbatch;
-	hashtable->growEnabled = false; //CSI3130
-	hashtable->totalTuples = 0;
-	hashtable->innerBatchFile = NULL;
-	hashtable->outerBatchFile = NULL;
-	hashtable->spaceUsed = 0;
-	hashtable->spaceAllowed = work_mem * 1024L;
-
-	/*
-	 * Get info about the hash functions to be used for each hash key.
-	 */
-	nkeys = list_length(hashOperators);
-	hashtable->hashfunctions = (FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
-	i = 0;
-	foreach(ho, hashOperators)
-	{
-		Oid			hashfn;
-
-		hashfn = get_op_hash_function(lfirst_oid(ho));
-		if (!OidIsValid(hashfn))
-			elog(ERROR, "could not find hash function for hash operator %u",
-				 lfirst_oid(ho));
-		fmgr_info(hashfn, &hashtable->hashfunctions[i]);
-		i++;
-	}
-
-	/*
-	 * Create temporary memory contexts in which to keep the hashtable working
-	 * storage.  See notes in executor/hashjoin.h.
-	 */
-	hashtable->hashCxt = AllocSetContextCreate(CurrentMemoryContext,
-											   "HashTableContext",
-											   ALLOCSET_DEFAULT_MINSIZE,
-											   ALLOCSET_DEFAULT_INITSIZE,
-											   ALLOCSET_DEFAULT_MAXSIZE);
-
-	hashtable->batchCxt = AllocSetContextCreate(hashtable->hashCxt,
-												"HashBatchContext",
-												ALLOCSET_DEFAULT_MINSIZE,
-												ALLOCSET_DEFAULT_INITSIZE,
-												ALLOCSET_DEFAULT_MAXSIZE);
-
-	/* Allocate data that will live for the life of the hashjoin */
-
-	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
-
-	if (nbatch > 1)
-	{
-		/*
-		 * allocate and initialize the file arrays in hashCxt
-		 */
-		hashtable->innerBatchFile = (BufFile **)
-			palloc0(nbatch * sizeof(BufFile *));
-		hashtable->outerBatchFile = (BufFile **)
-			palloc0(nbatch * sizeof(BufFile *));
-		/* The files will not be opened until needed... */
-	}
-
-	/*
-	 * Prepare context for the first-scan space allocations; allocate the
-	 * hashbucket array therein, and set each bucket "empty".
-	 */
-	MemoryContextSwitchTo(hashtable->batchCxt);
-
-	hashtable->buckets = (HashJoinTuple *)
-		palloc0(nbuckets * sizeof(HashJoinTuple));
-
-	MemoryContextSwitchTo(oldcxt);
-
-	return hashtable;
-}
-
-
-/*
- * Compute appropriate size for hashtable given the estimated size of the
- * relation to be hashed (number of rows and average row width).
- *
- * This is exported so that the planner's costsize.c can use it.
- */
-
-/* Target bucket loading (tuples per bucket) */
-#define NTUP_PER_BUCKET			10
-
-/* Prime numbers that we like to use as nbuckets values */
-static const int hprimes[] = {
-	1033, 2063, 4111, 8219, 16417, 32779, 65539, 131111,
-	262151, 524341, 1048589, 2097211, 4194329, 8388619, 16777289, 33554473,
-	67108913, 134217773, 268435463, 536870951, 1073741831
-};
-
-void
-ExecChooseHashTableSize(double ntuples, int tupwidth,
-						int *numbuckets,
-						int *numbatches)
-{
-	int			tupsize;
-	double		inner_rel_bytes;
-	long		hash_table_bytes;
-	int			nbatch;
-	int			nbuckets;
-	int			i;
-
-	/* Force a plausible relation size if no info */
-	if (ntuples <= 0.0)
-		ntuples = 1000.0;
-
-	/*
-	 * Estimate tupsize based on footprint of tuple in hashtable... note this
-	 * does not allow for any palloc overhead.	The manipulations of spaceUsed
-	 * don't count palloc overhead either.
-	 */
-	tupsize = MAXALIGN(sizeof(HashJoinTupleData)) +
-		MAXALIGN(sizeof(HeapTupleHeaderData)) +
-		MAXALIGN(tupwidth);
-	inner_rel_bytes = ntuples * tupsize;
-
-	/*
-	 * Target in-memory hashtable size is work_mem kilobytes.
-	 */
-	hash_table_bytes = work_mem * 1024L;
-
-	/*
-	 * Set nbuckets to achieve an average bucket load of NTUP_PER_BUCKET when
-	 * memory is filled.  Set nbatch to the smallest power of 2 that appears
-	 * sufficient.
-	 */
-	if (inner_rel_bytes > hash_table_bytes)
-	{
-		/* We'll need multiple batches */
-		long		lbuckets;
-		double		dbatch;
-		int			minbatch;
-
-		lbuckets = (hash_table_bytes / tupsize) / NTUP_PER_BUCKET;
-		lbuckets = Min(lbuckets, INT_MAX);
-		nbuckets = (int) lbuckets;
-
-		dbatch = ceil(inner_rel_bytes / hash_table_bytes);
-		dbatch = Min(dbatch, INT_MAX / 2);
-		minbatch = (int) dbatch;
-		nbatch = 2;
-		while (nbatch < minbatch)
-			nbatch <<= 1;
-	}
-	else
-	{
-		/* We expect the hashtable to fit in memory */
-		double		dbuckets;
-
-		dbuckets = ceil(ntuples / NTUP_PER_BUCKET);
-		dbuckets = Min(dbuckets, INT_MAX);
-		nbuckets = (int) dbuckets;
-
-		nbatch = 1;
-	}
-
-	/*
-	 * We want nbuckets to be prime so as to avoid having bucket and batch
-	 * numbers depend on only some bits of the hash code.  Choose the next
-	 * larger prime from the list in hprimes[].  (This also enforces that
-	 * nbuckets is not very small, by the simple expedient of not putting any
-	 * very small entries in hprimes[].)
-	 */
-	for (i = 0; i < (int) lengthof(hprimes); i++)
-	{
-		if (hprimes[i] >= nbuckets)
-		{
-			nbuckets = hprimes[i];
-			break;
-		}
-	}
-
-	*numbuckets = nbuckets;
-	*numbatches = nbatch;
-}
-
-
-/* ----------------------------------------------------------------
- *		ExecHashTableDestroy
- *
- *		destroy a hash table
- * ----------------------------------------------------------------
- */
-void
-ExecHashTableDestroy(HashJoinTable hashtable)
-{
-	int			i;
-
-	/*
-	 * Make sure all the temp files are closed.  We skip batch 0, since it
-	 * can't have any temp files (and the arrays might not even exist if
-	 * nbatch is only 1).
-	 */
-	for (i = 1; i < hashtable->nbatch; i++)
-	{
-		if (hashtable->innerBatchFile[i])
-			BufFileClose(hashtable->innerBatchFile[i]);
-		if (hashtable->outerBatchFile[i])
-			BufFileClose(hashtable->outerBatchFile[i]);
-	}
-
-	/* Release working memory (batchCxt is a child, so it goes away too) */
-	MemoryContextDelete(hashtable->hashCxt);
-
-	/* And drop the control block */
-	pfree(hashtable);
-}
-
-/*
- * ExecHashIncreaseNumBatches
- *		increase the original number of batches in order to reduce
- *		current memory consumption
- */
-static void
-ExecHashIncreaseNumBatches(HashJoinTable hashtable)
-{
-	int			oldnbatch = hashtable->nbatch;
-	int			curbatch = hashtable->curbatch;
-	int			nbatch;
-	int			i;
-	MemoryContext oldcxt;
-	long		ninmemory;
-	long		nfreed;
-
-	/* do nothing if we've decided to shut off growth */
-	if (!hashtable->growEnabled)
-		return;
-
-	/* safety check to avoid overflow */
-	if (oldnbatch > INT_MAX / 2)
-		return;
-
-	nbatch = oldnbatch * 2;
-	Assert(nbatch > 1);
-
-#ifdef HJDEBUG
-	printf("Increasing nbatch to %d because space = %lu\n",
-		   nbatch, (unsigned long) hashtable->spaceUsed);
-#endif
-
-	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
-
-	if (hashtable->innerBatchFile == NULL)
-	{
-		/* we had no file arrays before */
-		hashtable->innerBatchFile = (BufFile **)
-			palloc0(nbatch * sizeof(BufFile *));
-		hashtable->outerBatchFile = (BufFile **)
-			palloc0(nbatch * sizeof(BufFile *));
-	}
-	else
-	{
-		/* enlarge arrays and zero out added entries */
-		hashtable->innerBatchFile = (BufFile **)
-			repalloc(hashtable->innerBatchFile, nbatch * sizeof(BufFile *));
-		hashtable->outerBatchFile = (BufFile **)
-			repalloc(hashtable->outerBatchFile, nbatch * sizeof(BufFile *));
-		MemSet(hashtable->innerBatchFile + oldnbatch, 0,
-			   (nbatch - oldnbatch) * sizeof(BufFile *));
-		MemSet(hashtable->outerBatchFile + oldnbatch, 0,
-			   (nbatch - oldnbatch) * sizeof(BufFile *));
-	}
-
-	MemoryContextSwitchTo(oldcxt);
-
-	hashtable->nbatch = nbatch;
-
-	/*
-	 * Scan through the existing hash table entries and dump out any that are
-	 * no longer of the current batch.
-	 */
-	ninmemory = nfreed = 0;
-
-	for (i = 0; i < hashtable->nbuckets; i++)
-	{
-		HashJoinTuple prevtuple;
-		HashJoinTuple tuple;
-
-		prevtuple = NULL;
-		tuple = hashtable->buckets[i];
-
-		while (tuple != NULL)
-		{
-			/* save link in case we delete */
-			HashJoinTuple nexttuple = tuple->next;
-			int			bucketno;
-			int			batchno;
-
-			ninmemory++;
-			ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
-									  &bucketno, &batchno);
-			Assert(bucketno == i);
-			if (batchno == curbatch)
-			{
-				/* keep tuple */
-				prevtuple = tuple;
-			}
-			else
-			{
-				/* dump it out */
-				Assert(batchno > curbatch);
-				ExecHashJoinSaveTuple(&tuple->htup, tuple->hashvalue,
-									  &hashtable->innerBatchFile[batchno]);
-				/* and remove from hash table */
-				if (prevtuple)
-					prevtuple->next = nexttuple;
-				else
-					hashtable->buckets[i] = nexttuple;
-				/* prevtuple doesn't change */
-				hashtable->spaceUsed -=
-					MAXALIGN(sizeof(HashJoinTupleData)) + tuple->htup.t_len;
-				pfree(tuple);
-				nfreed++;
-			}
-
-			tuple = nexttuple;
-		}
-	}
-
-#ifdef HJDEBUG
-	printf("Freed %ld of %ld tuples, space now %lu\n",
-		   nfreed, ninmemory, (unsigned long) hashtable->spaceUsed);
-#endif
-
-	/*
-	 * If we dumped out either all or none of the tuples in the table, disable
-	 * further expansion of nbatch.  This situation implies that we have
-	 * enough tuples of identical hashvalues to overflow spaceAllowed.
-	 * Increasing nbatch will not fix it since there's no way to subdivide the
-	 * group any more finely. We have to just gut it out and hope the server
-	 * has enough RAM.
-	 */
-	if (nfreed == 0 || nfreed == ninmemory)
-	{
-		hashtable->growEnabled = false;
-#ifdef HJDEBUG
-		printf("Disabling further increase of nbatch\n");
-#endif
-	}
-}
-
-/*
- * ExecHashTableInsert
- *		insert a tuple into the hash table depending on the hash value
- *		it may just go to a temp file for later batches
- */
-void
-ExecHashTableInsert(HashJoinTable hashtable,
-					HeapTuple tuple,
-					uint32 hashvalue)
-{
-	int			bucketno;
-	int			batchno;
-
-	ExecHashGetBucketAndBatch(hashtable, hashvalue,
-							  &bucketno, &batchno);
-
-	/*
-	 * decide whether to put the tuple in the hash table or a temp file
-	 */
-	if (batchno == hashtable->curbatch)
-	{
-		/*
-		 * put the tuple in hash table
-		 */
-		HashJoinTuple hashTuple;
-		int			hashTupleSize;
-
-		hashTupleSize = MAXALIGN(sizeof(HashJoinTupleData)) + tuple->t_len;
-		hashTuple = (HashJoinTuple) MemoryContextAlloc(hashtable->batchCxt,
-													   hashTupleSize);
-		hashTuple->hashvalue = hashvalue;
-		memcpy((char *) &hashTuple->htup,
-			   (char *) tuple,
-			   sizeof(hashTuple->htup));
-		hashTuple->htup.t_datamcxt = hashtable->batchCxt;
-		hashTuple->htup.t_data = (HeapTupleHeader)
-			(((char *) hashTuple) + MAXALIGN(sizeof(HashJoinTupleData)));
-		memcpy((char *) hashTuple->htup.t_data,
-			   (char *) tuple->t_data,
-			   tuple->t_len);
-		hashTuple->next = hashtable->buckets[bucketno];
-		hashtable->buckets[bucketno] = hashTuple;
-		hashtable->spaceUsed += hashTupleSize;
-		if (hashtable->spaceUsed > hashtable->spaceAllowed)
-			ExecHashIncreaseNumBatches(hashtable);
-	}
-	else
-	{
-		/*
-		 * put the tuple into a temp file for later batches
-		 */
-		Assert(batchno > hashtable->curbatch);
-		ExecHashJoinSaveTuple(tuple, hashvalue,
-							  &hashtable->innerBatchFile[batchno]);
-	}
-}
-
-/*
- * ExecHashGetHashValue
- *		Compute the hash value for a tuple
- *
- * The tuple to be tested must be in either econtext->ecxt_outertuple or
- * econtext->ecxt_innertuple.  Vars in the hashkeys expressions reference
- * either OUTER or INNER.
- */
-uint32
-ExecHashGetHashValue(HashJoinTable hashtable,
-					 ExprContext *econtext,
-					 List *hashkeys)
-{
-	uint32		hashkey = 0;
-	ListCell   *hk;
-	int			i = 0;
-	MemoryContext oldContext;
-
-	/*
-	 * We reset the eval context each time to reclaim any memory leaked in the
-	 * hashkey expressions.
-	 */
-	ResetExprContext(econtext);
-
-	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
-
-	foreach(hk, hashkeys)
-	{
-		ExprState  *keyexpr = (ExprState *) lfirst(hk);
-		Datum		keyval;
-		bool		isNull;
-
-		/* rotate hashkey left 1 bit at each step */
-		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
-
-		/*
-		 * Get the join attribute value of the tuple
-		 */
-		keyval = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
-
-		/*
-		 * Compute the hash function
-		 */
-		if (!isNull)			/* treat nulls as having hash key 0 */
-		{
-			uint32		hkey;
-
-			hkey = DatumGetUInt32(FunctionCall1(&hashtable->hashfunctions[i],
-												keyval));
-			hashkey ^= hkey;
-		}
-
-		i++;
-	}
-
-	MemoryContextSwitchTo(oldContext);
-
-	return hashkey;
-}
-
-/*
- * ExecHashGetBucketAndBatch
- *		Determine the bucket number and batch number for a hash value
- *
- * Note: on-the-fly increases of nbatch must not change the bucket number
- * for a given hash code (since we don't move tuples to different hash
- * chains), and must only cause the batch number to remain the same or
- * increase.  Our algorithm is
- *		bucketno = hashvalue MOD nbuckets
- *		batchno = (hashvalue DIV nbuckets) MOD nbatch
- * where nbuckets should preferably be prime so that all bits of the
- * hash value can affect both bucketno and batchno.
- * nbuckets doesn't change over the course of the join.
- *
- * nbatch is always a power of 2; we increase it only by doubling it.  This
- * effectively adds one more bit to the top of the batchno.
- */
-void
-ExecHashGetBucketAndBatch(HashJoinTable hashtable,
-						  uint32 hashvalue,
-						  int *bucketno,
-						  int *batchno)
-{
-	uint32		nbuckets = (uint32) hashtable->nbuckets;
-	uint32		nbatch = (uint32) hashtable->nbatch;
-
-	if (nbatch > 1)
-	{
-		*bucketno = hashvalue % nbuckets;
-		/* since nbatch is a power of 2, can do MOD by masking */
-		*batchno = (hashvalue / nbuckets) & (nbatch - 1);
-	}
-	else
-	{
-		*bucketno = hashvalue % nbuckets;
-		*batchno = 0;
-	}
-}
-
-/*
- * ExecScanHashBucket
- *		scan a hash bucket for matches to the current outer tuple
- *
- * The current outer tuple must be stored in econtext->ecxt_outertuple.
- */
-HeapTuple
-ExecScanHashBucket(HashJoinState *hjstate,
-				   ExprContext *econtext) {
-    //CSI3130
-    if (hjstate->hj_InFetched) { //CSI3130
-        List *hjclauses = hjstate->hashclauses;
-        HashJoinTable hashtable = hjstate->hj_OutHashTable;
-        HashJoinTuple hashTuple = hjstate->hj_OutCurTuple;
-        uint32 hashvalue = hjstate->hj_InCurHashValue;
-        /*
-         * hj_CurTuple is NULL to start scanning a new bucket, or the address of
-         * the last tuple returned from the current bucket.
-         */
-        if (hashTuple == NULL)
-            hashTuple = hashtable->buckets[hjstate->hj_OutCurBucketNo];
-        else
-            hashTuple = hashTuple->next;
-
-        while (hashTuple != NULL) {
-            if (hashTuple->hashvalue == hashvalue) {
-                HeapTuple heapTuple = &hashTuple->htup;
-                TupleTableSlot *inntuple;
-
-                /* insert hashtable's tuple into exec slot so ExecQual sees it */
-                inntuple = ExecStoreTuple(heapTuple,
-                                          hjstate->hj_OutHashTupleSlot, //CSI3130
-                                          InvalidBuffer,
-                                          false);    /* do not pfree */
-                econtext->ecxt_innertuple = inntuple;
-
-                /* reset temp memory each time to avoid leaks from qual expr */
-                ResetExprContext(econtext);
-
-                if (ExecQual(hjclauses, econtext, false)) {
-                    hjstate->hj_OutCurTuple = hashTuple;
-                    return heapTuple;
-                }
-                hashTuple = hashTuple->next;
-            }
-
-        }
-
-        return NULL;
-    } else {
-        List *hjclauses = hjstate->hashclauses; //cSI3130
-        HashJoinTable hashtable = hjstate->hj_InHashTable; //CSI3130
-        HashJoinTuple hashTuple = hjstate->hj_InCurTuple; //cSI3130
-        uint32 hashvalue = hjstate->hj_OutCurHashValue;
-
-
-        if(hashTuple == NULL)
-            hashTuple = hashtable->buckets[hjstate->hj_InCurBucketNo];
-        else
-            hashTuple = hashTuple->next;
-
-        while(hashTuple != NULL){
-            if(hashTuple->hashvalue == hashvalue){
-                HeapTuple heapTuple = &hashTuple->htup;
-                TupleTableSlot *inntuple;
-
-                inntuple = ExecStoreTuple(heapTuple,
-                                          hjstate->hj_InHashTupleSlot, //CSI3130
-                                          InvalidBuffer,
-                                          false);    /* do not pfree */
-                econtext->ecxt_innertuple = inntuple;
-
-                /* reset temp memory each time to avoid leaks from qual expr */
-                ResetExprContext(econtext);
-
-                if (ExecQual(hjclauses, econtext, false)) {
-                    hjstate->hj_InCurTuple = hashTuple;
-                    return heapTuple;
-                }
-                hashTuple = hashTuple->next;
-
-            }
-        }
-    }
-}
-
-/*
- * ExecHashTableReset
- *
- *		reset hash table header for new batch
- */
-void
-ExecHashTableReset(HashJoinTable hashtable) {
-        MemoryContext oldcxt;
-        int nbuckets = hashtable->nbuckets;
-
-        /*
-         * Release all the hash buckets and tuples acquired in the prior pass, and
-         * reinitialize the context for a new pass.
-         */
-        MemoryContextReset(hashtable->batchCxt);
-        oldcxt = MemoryContextSwitchTo(hashtable->batchCxt);
-
-        /* Reallocate and reinitialize the hash bucket headers. */
-        hashtable->buckets = (HashJoinTuple *)
-                palloc0(nbuckets * sizeof(HashJoinTuple));
-
-        hashtable->spaceUsed = 0;
-
-        MemoryContextSwitchTo(oldcxt);
-}
-
-void
-ExecReScanHash(HashState *node, ExprContext *exprCtxt) {
-        /*
-         * if chgParam of subnode is not null then plan will be re-scanned by
-         * first ExecProcNode.
-         */
-        if (((PlanState *) node)->lefttree->chgParam == NULL)
-            ExecReScan(((PlanState *) node)->lefttree, exprCtxt);
-}
\ No newline at end of file
+/*-------------------------------------------------------------------------
+ *
+ * nodeHash.c
+ *	  Routines to hash relations for hashjoin
+ *
+ * Portions Copyright (c) 1996-2005, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  $PostgreSQL: pgsql/src/backend/executor/nodeHash.c,v 1.96.2.2 2005/11/23 20:28:04 tgl Exp $
+ *
+ *-------------------------------------------------------------------------
+ */
+/*
+ * INTERFACE ROUTINES
+ *		MultiExecHash	- generate an in-memory hash table of the relation
+ *		ExecInitHash	- initialize node and subnodes
+ *		ExecEndHash		- shutdown node and subnodes
+ */
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "access/heapam.h"
+#include "access/xact.h"
+#include "catalog/pg_statistic.h"
+#include "executor/execdebug.h"
+#include "executor/hashjoin.h"
+#include "executor/instrument.h"
+#include "executor/nodeHash.h"
+#include "executor/nodeHashjoin.h"
+#include "miscadmin.h"
+#include "optimizer/var.h"
+#include "parser/parse_expr.h"
+#include "parser/parsetree.h"
+#include "storage/fd.h"
+#include "utils/memutils.h"
+#include "utils/lsyscache.h"
+#include "utils/pg_crc.h"
+#include "utils/pg_lzcompress.h"
+#include "utils/syscache.h"
+#include "../../include/nodes/execnodes.h"
+#include "../../include/executor/hashjoin.h"
+
+
+/*
+ * Batch file block header; see HashJoinBatchFileData.
+ */
+typedef struct HashJoinSpillBlock
+{
+	uint32		ntuples;		/* # records in the block */
+	uint32		rawlen;			/* length of the records */
+	uint32		storedlen;		/* length as written, after compression */
+	uint32		flags;			/* see below */
+	pg_crc32	crc;			/* CRC of the bytes as written */
+} HashJoinSpillBlock;
+
+#define HJ_SPILL_COMPRESSED		0x0001	/* block is a PGLZ_Header + data */
+
+static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
+static HeapTuple ExecHashLateTuple(HashJoinTable hashtable, HeapTuple tuple);
+static uint32 ExecChooseHashBloomSize(long nbuckets);
+static void ExecHashBloomAdd(HashJoinTable hashtable, uint32 hashvalue);
+static bool ExecHashBloomCheck(HashJoinTable hashtable, uint32 hashvalue);
+static int	ExecHashGetMCVHashValues(HashJoinTable hashtable,
+						 HashState *hashstate,
+						 uint32 *hashvalues, float4 *freqs,
+						 int maxvalues);
+static void ExecHashRemoveNextSkewBucket(HashJoinTable hashtable,
+							 HashJoinTuple unprobed);
+static void ExecHashDropSkewBucket(HashJoinTable hashtable,
+					   HashJoinTuple unprobed);
+static HashJoinTuple ExecHashCopyTuple(HashJoinTable hashtable,
+				  HeapTuple tuple, uint32 hashvalue,
+				  int *hashTupleSize);
+static void ExecHashWindowAdd(HashJoinTable hashtable,
+				  HashJoinTuple hashTuple, long bucketno);
+static void ExecHashTableInsertTuple(HashJoinTable hashtable,
+						 HeapTuple tuple, uint32 hashvalue,
+						 bool joined);
+static void ExecHashEnlargeBatchArrays(HashJoinTable hashtable, int nbatch);
+static void ExecHashFlushBatches(HashJoinTable hashtable);
+static bool ExecHashSplitBatches(HashJoinTable hashtable);
+static void ExecHashCountBatchSpace(HashJoinTable hashtable);
+static long ExecHashDumpBatches(HashJoinTable hashtable,
+					HashJoinTuple unprobed, long *ninmemory);
+static void ExecHashBatchFileFlush(HashJoinBatchFile file);
+static bool ExecHashBatchFileLoad(HashJoinBatchFile file);
+static void ExecHashBatchFileEnlarge(HashJoinBatchFile file, Size size);
+static double ExecHashSpillElapsed(struct timeval *starttime);
+static void ExecChooseHashTableSizeMem(double ntuples, int tupwidth,
+						   long hash_table_bytes,
+						   long *numbuckets, int *numbatches);
+static char *ExecHashArenaMapFile(Size size);
+static bool ExecHashArenaReserve(int fd, Size size);
+static char *ExecHashArenaMapAnon(Size *size, bool *hugepages);
+static HashJoinArenaData *ExecHashArenaCreate(Size size, bool anonymous,
+					bool persistent);
+static void ExecHashArenaDestroy(HashJoinArenaData *arena);
+static void ExecHashArenaAtXactEnd(XactEvent event, void *arg);
+static void *ExecHashArenaAlloc(HashJoinTable hashtable, Size size);
+static void ExecHashArenaFree(HashJoinTable hashtable, void *pointer);
+static bool ExecHashMapArena(HashJoinTable hashtable);
+static HashJoinTuple *ExecHashAllocBuckets(HashJoinTable hashtable,
+					 long nbuckets);
+
+/*
+ * CSI3130: windowed symmetric join for unbounded inputs.  If greater than
+ * zero, each hash table keeps only the most recent hashjoin_window_size
+ * tuples of its input; older tuples are evicted and no longer match.
+ */
+int			hashjoin_window_size = 0;
+
+/*
+ * CSI3130: persistent symmetric join state for incremental view
+ * maintenance.  If set (non-empty), an inner hash join keeps its two hash
+ * tables under this name after it has read both inputs to the end, and
+ * the next join run under the same name starts from them; see
+ * ExecHashJoinClaimState.
+ */
+char	   *hashjoin_state_name = NULL;
+
+/*
+ * CSI3130: checkpoints of long-running symmetric joins.  If a file name is
+ * set (by a superuser; it must be an absolute path), a hash join writes its
+ * state there after each hashjoin_checkpoint_interval input rows, and a
+ * join that finds the file at startup resumes from it; see
+ * ExecHashJoinCheckpoint.
+ */
+char	   *hashjoin_checkpoint_file = NULL;
+int			hashjoin_checkpoint_interval = 1000000;
+
+/*
+ * CSI3130: compress the blocks of batch files with pglz.  Worth it when
+ * the temp file volume, rather than the CPU, limits a spilling join.
+ */
+bool		hashjoin_spill_compression = false;
+
+/*
+ * CSI3130: the order in which the batches spilled to temp files are joined
+ * once both inputs have ended; see ExecHashJoinNewBatch.
+ */
+char	   *hashjoin_batch_order_string = NULL;
+int			hashjoin_batch_order = HJ_BATCH_ORDER_LARGEST;
+
+/*
+ * CSI3130: how a hash table that has run out of memory during the first
+ * pass picks the batches to flush; see ExecHashFlushBatches.
+ */
+char	   *hashjoin_flush_policy_string = NULL;
+int			hashjoin_flush_policy = HJ_FLUSH_LARGEST;
+
+/*
+ * CSI3130: memory limit, in kilobytes, for hash tables kept in a
+ * memory-mapped temp file.  If greater than work_mem, a table that
+ * outgrows work_mem maps such a file of this size, buckets included, and
+ * goes on in it, leaving it to the kernel to page it, so that an input
+ * that is a bit larger than work_mem (but fits in RAM) needn't be split
+ * into batches.  Zero turns this off.
+ *
+ * The mapping is shared, so the kernel writes the pages the table dirties
+ * back to the file in the background, even when memory isn't short: each
+ * byte beyond work_mem may cost a write, like a spilled batch, though it
+ * is only read back if its page was evicted.  Where there is RAM enough,
+ * raising work_mem is cheaper; this is for a few large joins when a
+ * work_mem that large can't be afforded for every hash join at once.
+ * Tables that fit in work_mem never map the file.  One that does reserves
+ * the file's full size on the temp volume first, and batches as usual if
+ * it can't.
+ */
+int			hashjoin_mmap_mem = 0;
+
+/*
+ * CSI3130: back large hash tables with transparent huge pages.  Random
+ * probes into big bucket arrays and tuple storage miss the TLB on nearly
+ * every access with 4 kB pages.  If set, tables keep their tuples in an
+ * anonymous arena, and the mappings behind arenas and bucket arrays are
+ * aligned to HJ_HUGE_PAGE_SIZE and madvise()d for huge pages, where the
+ * platform has them.
+ */
+bool		hashjoin_huge_pages = false;
+
+/* arenas not yet unmapped; see ExecHashArenaAtXactEnd */
+static HashJoinArenaData *liveArenas = NULL;
+
+/*
+ * Bucket arrays at least this large are mapped rather than palloc'd, so
+ * that creating a table doesn't have to zero an array sized for the
+ * planner's estimate before the first row arrives.
+ */
+#define HJ_LAZY_BUCKETS_SIZE	(1024 * 1024)
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS			MAP_ANON
+#endif
+
+/* size (and alignment) of a transparent huge page on the usual platforms */
+#define HJ_HUGE_PAGE_SIZE		(2 * 1024 * 1024)
+
+/* where fd.c's OpenTemporaryFile puts its files, and their name prefix */
+#define HJ_TEMP_FILES_DIR		"pgsql_tmp"
+#define HJ_TEMP_FILE_PREFIX		"pgsql_tmp"
+
+/* bytes written at a time to reserve a hash table file's space */
+#define HJ_RESERVE_CHUNK		(64 * BLCKSZ)
+
+#define HJ_IN_ARENA(arena, pointer) \
+	((arena) != NULL && (char *) (pointer) >= (arena)->base && \
+	 (char *) (pointer) < (arena)->base + (arena)->size)
+
+
+/* ----------------------------------------------------------------
+ *		ExecHash
+ *
+ *		CHANGED for CSI3130 Project
+ * ----------------------------------------------------------------
+ *
+ * NOTE: This is the method that has been altered for CSI3130 project
+ */
+TupleTableSlot *
+ExecHash(HashState *node)
+{
+    /*
+     * CSI3130
+     */
+	PlanState *outerNode;
+    List *hashkeys;
+    HashJoinTable hashtable;
+    TupleTableSlot *slot;
+    ExprContext *econtext;
+    HeapTuple tuple;
+    uint32 val;
+
+    if (node->ps.instrument){ //Instrumentation
+        InstrStartNode(node->ps.instrument);
+    }
+
+    outerNode = outerPlanState(node); //Node's StateInfo
+    hashtable = node->hashtable;
+
+    hashkeys = node->hashkeys; //Expression contextt
+    econtext = node->ps.ps_ExprContext;
+
+    for (;;)
+    {
+        slot = ExecProcNode(outerNode); //Get all tuples, insert into table
+
+        if(TupIsNull(slot))
+        {
+            if (node->ps.instrument)
+                InstrStopNodeMulti(node->ps.instrument, 0);
+            return NULL;
+        }
+
+        econtext->ecxt_innertuple = slot; //Compute hash val
+        econtext->ecxt_outertuple = slot;
+        val = ExecHashGetHashValue(hashtable, econtext, hashkeys);
+
+        /*
+         * Once the other input is exhausted, the parent gives us its table
+         * as a runtime filter: a tuple that its Bloom filter rules out can't
+         * join with anything, so drop it right here rather than handing it
+         * up to be probed.  Nothing will ever probe our own table again
+         * either, so tuples that pass are not inserted, unless they belong
+         * to a flushed batch: those must be saved for it.
+         */
+        if (node->filtertable != NULL)
+        {
+            if (!ExecHashBloomCheck(node->filtertable, val))
+            {
+                node->nfiltered += 1;
+                continue;
+            }
+            if (hashtable->nbatch > 1 &&
+                ExecHashGetSkewBucket(hashtable, val) == INVALID_SKEW_BUCKET_NO)
+            {
+                long bucketno;
+                int batchno;
+
+                ExecHashGetBucketAndBatch(hashtable, val, &bucketno, &batchno);
+                if (!HJ_BATCH_RESIDENT(hashtable, batchno))
+                    break;
+            }
+            if (node->ps.instrument)
+                InstrStopNodeMulti(node->ps.instrument, 1);
+            return slot;
+        }
+        break;
+    }
+
+    hashtable->totalTuples += 1;
+
+    /*
+     * Under late materialization only the key columns and t_self go into
+     * the table; the slot we return still holds the full tuple.
+     */
+    tuple = ExecFetchSlotTuple(slot);
+    if (hashtable->lateRel != NULL)
+    {
+        tuple = ExecHashLateTuple(hashtable, tuple);
+        ExecHashTableInsert(hashtable, tuple, val);
+        heap_freetuple(tuple);
+    }
+    else
+        ExecHashTableInsert(hashtable, tuple, val);
+
+    if (node->ps.instrument)
+        InstrStopNodeMulti(node->ps.instrument, hashtable->totalTuples);
+
+    return slot; //return tuple
+}
+
+/* ----------------------------------------------------------------
+ *		MultiExecHash
+ *
+ *		build hash table for hashjoin, doing partitioning if more
+ *		than one batch is required.
+ * ----------------------------------------------------------------
+ */
+Node *
+MultiExecHash(HashState *node)
+{
+	PlanState  *outerNode;
+	List	   *hashkeys;
+	HashJoinTable hashtable;
+	TupleTableSlot *slot;
+	ExprContext *econtext;
+	uint32		hashvalue;
+
+	/* must provide our own instrumentation support */
+	if (node->ps.instrument)
+		InstrStartNode(node->ps.instrument);
+
+	/*
+	 * get state info from node
+	 */
+	outerNode = outerPlanState(node);
+	hashtable = node->hashtable;
+
+	/*
+	 * set expression context
+	 */
+	hashkeys = node->hashkeys;
+	econtext = node->ps.ps_ExprContext;
+
+	/*
+	 * get all inner tuples and insert into the hash table (or temp files)
+	 */
+	for (;;)
+	{
+		slot = ExecProcNode(outerNode);
+		if (TupIsNull(slot))
+			break;
+		hashtable->totalTuples += 1;
+		/* We have to compute the hash value */
+		econtext->ecxt_innertuple = slot;
+		hashvalue = ExecHashGetHashValue(hashtable, econtext, hashkeys);
+		ExecHashTableInsert(hashtable, ExecFetchSlotTuple(slot), hashvalue);
+	}
+
+	/* must provide our own instrumentation support */
+	if (node->ps.instrument)
+		InstrStopNodeMulti(node->ps.instrument, hashtable->totalTuples);
+
+	/*
+	 * We do not return the hash table directly because it's not a subtype of
+	 * Node, and so would violate the MultiExecProcNode API.  Instead, our
+	 * parent Hashjoin node is expected to know how to fish it out of our node
+	 * state.  Ugly but not really worth cleaning up, since Hashjoin knows
+	 * quite a bit more about Hash besides that.
+	 */
+	return NULL;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitHash
+ *
+ *		Init routine for Hash node
+ * ----------------------------------------------------------------
+ */
+HashState *
+ExecInitHash(Hash *node, EState *estate)
+{
+	HashState  *hashstate;
+
+	SO_printf("ExecInitHash: initializing hash node\n");
+
+	/*
+	 * create state structure
+	 */
+	hashstate = makeNode(HashState);
+	hashstate->ps.plan = (Plan *) node;
+	hashstate->ps.state = estate;
+	hashstate->hashtable = NULL;
+	hashstate->hashkeys = NIL;	/* will be set by parent HashJoin */
+	hashstate->filtertable = NULL;
+	hashstate->nfiltered = 0;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * create expression context for node
+	 */
+	ExecAssignExprContext(estate, &hashstate->ps);
+
+#define HASH_NSLOTS 1
+
+	/*
+	 * initialize our result slot
+	 */
+	ExecInitResultTupleSlot(estate, &hashstate->ps);
+
+	/*
+	 * initialize child expressions
+	 */
+	hashstate->ps.targetlist = (List *)
+		ExecInitExpr((Expr *) node->plan.targetlist,
+					 (PlanState *) hashstate);
+	hashstate->ps.qual = (List *)
+		ExecInitExpr((Expr *) node->plan.qual,
+					 (PlanState *) hashstate);
+
+	/*
+	 * initialize child nodes
+	 */
+	outerPlanState(hashstate) = ExecInitNode(outerPlan(node), estate);
+
+	/*
+	 * initialize tuple type. no need to initialize projection info because
+	 * this node doesn't do projections
+	 */
+	ExecAssignResultTypeFromTL(&hashstate->ps);
+	hashstate->ps.ps_ProjInfo = NULL;
+
+	return hashstate;
+}
+
+int
+ExecCountSlotsHash(Hash *node)
+{
+	return ExecCountSlotsNode(outerPlan(node)) +
+		ExecCountSlotsNode(innerPlan(node)) +
+		HASH_NSLOTS;
+}
+
+/* ---------------------------------------------------------------
+ *		ExecEndHash
+ *
+ *		clean up routine for Hash node
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndHash(HashState *node)
+{
+	PlanState  *outerPlan;
+
+	/*
+	 * free exprcontext
+	 */
+	ExecFreeExprContext(&node->ps);
+
+	/*
+	 * shut down the subplan
+	 */
+	outerPlan = outerPlanState(node);
+	ExecEndNode(outerPlan);
+}
+
+
+/* ----------------------------------------------------------------
+ *		ExecHashTableCreate
+ *
+ *		create an empty hashtable data structure for hashjoin.
+ *
+ *		If persistent, the table is kept entirely outside the query's
+ *		memory (under TopMemoryContext) and in a single batch, so that it
+ *		can outlive the query; see ExecHashJoinClaimState.
+ * ----------------------------------------------------------------
+ */
+HashJoinTable
+ExecHashTableCreate(Hash *node, List *hashOperators, bool persistent,
+					bool checkpointed)
+{
+	HashJoinTable hashtable;
+	MemoryContext parentcxt;
+	Plan	   *outerNode;
+	long		nbuckets;
+	int			nbatch;
+	bool		singlebatch = false;
+	bool		usemmap;
+	int			nkeys;
+	int			i;
+	ListCell   *ho;
+	MemoryContext oldcxt;
+
+	/*
+	 * Get information about the size of the relation to be hashed (it's the
+	 * "outer" subtree of this node, but the inner relation of the hashjoin).
+	 * Compute the appropriate size of the hash table.
+	 */
+	outerNode = outerPlan(node);
+
+	/*
+	 * A windowed table never holds more than the window, however large
+	 * (or unbounded) its input is, so size it for that and never batch.
+	 */
+	if (hashjoin_window_size > 0)
+	{
+		ExecChooseHashTableSizeMem((double) hashjoin_window_size,
+								   outerNode->plan_width, work_mem * 1024L,
+								   &nbuckets, &nbatch);
+		singlebatch = true;
+	}
+	else
+		ExecChooseHashTableSizeMem(outerNode->plan_rows, outerNode->plan_width,
+								   work_mem * 1024L, &nbuckets, &nbatch);
+
+	/*
+	 * Batch files can't outlive the query, so neither persistent nor
+	 * checkpointed state can spill.  (A checkpointed table gives up its
+	 * checkpoints rather than work_mem, though; see
+	 * ExecHashIncreaseNumBatches.)
+	 */
+	if (persistent || checkpointed)
+		singlebatch = true;
+	if (singlebatch)
+		nbatch = 1;
+	parentcxt = persistent ? TopMemoryContext : CurrentMemoryContext;
+
+	/*
+	 * A table that would spill may use a memory-mapped file instead, which
+	 * lets it hold more before it has to.  Size it for that limit.
+	 */
+	usemmap = (!singlebatch && hashjoin_mmap_mem > work_mem);
+	if (usemmap)
+		ExecChooseHashTableSizeMem(outerNode->plan_rows, outerNode->plan_width,
+								   hashjoin_mmap_mem * 1024L,
+								   &nbuckets, &nbatch);
+
+#ifdef HJDEBUG
+	printf("nbatch = %d, nbuckets = %ld\n", nbatch, nbuckets);
+#endif
+
+	/*
+	 * Initialize the hash table control block.
+	 *
+	 * The hashtable control block is just palloc'd from the executor's
+	 * per-query memory context (unless the table is persistent).
+	 */
+	hashtable = (HashJoinTable) MemoryContextAlloc(parentcxt,
+												   sizeof(HashJoinTableData));
+	hashtable->nbuckets = nbuckets;
+	hashtable->buckets = NULL;
+	hashtable->nbatch = nbatch;
+	hashtable->curbatch = 0;
+	hashtable->nbatch_original = nbatch;
+	hashtable->nbatch_outstart = nbatch;
+	hashtable->growEnabled = !singlebatch;
+	hashtable->partner = NULL;	/* see ExecHashTableLink */
+	hashtable->newestTuple = NULL;
+	hashtable->spillBytes = NULL;
+	MemSet(&hashtable->spillStats, 0, sizeof(HashJoinSpillStats));
+	hashtable->batchResident = NULL;
+	hashtable->batchSpace = NULL;
+	hashtable->batchHits = NULL;
+	hashtable->batchesFlushed = 0;
+	hashtable->flushedSpace = 0;
+	hashtable->totalTuples = 0;
+	hashtable->unjoinedBatchFile = NULL;
+	hashtable->joinedBatchFile = NULL;
+	hashtable->spaceUsed = 0;
+	hashtable->spaceAllowed = work_mem * 1024L;
+	hashtable->arena = NULL;
+	hashtable->bucketArena = NULL;
+	hashtable->mmapSize = 0;
+	hashtable->lateRel = NULL;		/* see ExecHashLateMaterialize */
+	hashtable->lateTupDesc = NULL;
+	hashtable->lateKeepAttr = NULL;
+	hashtable->lateValues = NULL;
+	hashtable->lateNulls = NULL;
+	hashtable->bloomFilter = NULL;
+	hashtable->nbloomBlocks = ExecChooseHashBloomSize(nbuckets);
+	hashtable->bloomPassed = 0;
+	hashtable->bloomRejected = 0;
+	hashtable->skewEnabled = false;		/* see ExecHashBuildSkewHash */
+	hashtable->skewBucket = NULL;
+	hashtable->skewBucketLen = 0;
+	hashtable->nSkewBuckets = 0;
+	hashtable->skewBucketNums = NULL;
+	hashtable->spaceUsedSkew = 0;
+	hashtable->skewSpaceAllowed = 0;
+	hashtable->skewTuples = 0;
+	hashtable->windowSize = hashjoin_window_size;
+	hashtable->windowNext = 0;
+	hashtable->windowRing = NULL;
+	hashtable->bucketTails = NULL;
+	hashtable->windowEvicted = 0;
+	hashtable->purgedTuples = 0;
+	hashtable->persistent = persistent;
+	hashtable->checkpointed = checkpointed;
+
+	/*
+	 * Get info about the hash functions to be used for each hash key.
+	 */
+	nkeys = list_length(hashOperators);
+	hashtable->hashfunctions = (FmgrInfo *)
+		MemoryContextAlloc(parentcxt, nkeys * sizeof(FmgrInfo));
+	i = 0;
+	foreach(ho, hashOperators)
+	{
+		Oid			hashfn;
+
+		hashfn = get_op_hash_function(lfirst_oid(ho));
+		if (!OidIsValid(hashfn))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 lfirst_oid(ho));
+		fmgr_info_cxt(hashfn, &hashtable->hashfunctions[i], parentcxt);
+		i++;
+	}
+
+	/*
+	 * Create temporary memory contexts in which to keep the hashtable working
+	 * storage.  See notes in executor/hashjoin.h.
+	 */
+	hashtable->hashCxt = AllocSetContextCreate(parentcxt,
+											   "HashTableContext",
+											   ALLOCSET_DEFAULT_MINSIZE,
+											   ALLOCSET_DEFAULT_INITSIZE,
+											   ALLOCSET_DEFAULT_MAXSIZE);
+
+	hashtable->batchCxt = AllocSetContextCreate(hashtable->hashCxt,
+												"HashBatchContext",
+												ALLOCSET_DEFAULT_MINSIZE,
+												ALLOCSET_DEFAULT_INITSIZE,
+												ALLOCSET_DEFAULT_MAXSIZE);
+
+	/* Allocate data that will live for the life of the hashjoin */
+
+	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+
+	if (usemmap)
+	{
+		/* mapped only if the table outgrows work_mem; see ExecHashMapArena */
+		hashtable->mmapSize = hashjoin_mmap_mem * 1024L;
+	}
+	else if (hashjoin_huge_pages && !persistent &&
+			 hashtable->windowSize == 0 &&
+			 hashtable->spaceAllowed >= HJ_HUGE_PAGE_SIZE)
+	{
+		/*
+		 * Windowed tables reuse evicted tuples' memory, which an arena
+		 * can't do, so they stay in batchCxt.
+		 */
+		hashtable->arena =
+			ExecHashArenaCreate(hashtable->spaceAllowed +
+								nbuckets * sizeof(HashJoinTuple), true, false);
+	}
+
+	if (nbatch > 1)
+	{
+		/*
+		 * allocate and initialize the file arrays in hashCxt
+		 */
+		hashtable->unjoinedBatchFile = (HashJoinBatchFile *)
+			palloc0(nbatch * sizeof(HashJoinBatchFile));
+		hashtable->joinedBatchFile = (HashJoinBatchFile *)
+			palloc0(nbatch * sizeof(HashJoinBatchFile));
+		hashtable->spillBytes = (double *)
+			palloc0(nbatch * sizeof(double));
+		hashtable->batchResident = (bool *) palloc(nbatch * sizeof(bool));
+		MemSet(hashtable->batchResident, true, nbatch * sizeof(bool));
+		hashtable->batchSpace = (Size *) palloc0(nbatch * sizeof(Size));
+		hashtable->batchHits = (double *) palloc0(nbatch * sizeof(double));
+		/* The files will not be opened until needed... */
+	}
+
+	/* The Bloom filter lives as long as the hash join */
+	hashtable->bloomFilter = (uint32 *)
+		palloc0(hashtable->nbloomBlocks * HJ_BLOOM_BLOCK_WORDS * sizeof(uint32));
+
+	if (hashtable->windowSize > 0)
+		hashtable->windowRing = (HashJoinTuple *)
+			palloc0(hashtable->windowSize * sizeof(HashJoinTuple));
+
+	/*
+	 * Prepare context for the first-scan space allocations; allocate the
+	 * hashbucket array therein, and set each bucket "empty".
+	 */
+	MemoryContextSwitchTo(hashtable->batchCxt);
+
+	hashtable->buckets = ExecHashAllocBuckets(hashtable, nbuckets);
+	if (hashtable->windowSize > 0)
+		hashtable->bucketTails = (HashJoinTuple *)
+			palloc0(nbuckets * sizeof(HashJoinTuple));
+
+	MemoryContextSwitchTo(oldcxt);
+
+	return hashtable;
+}
+
+
+/*
+ * Compute appropriate size for hashtable given the estimated size of the
+ * relation to be hashed (number of rows and average row width).
+ *
+ * This is exported so that the planner's costsize.c can use it.
+ */
+
+/* Target bucket loading (tuples per bucket) */
+#define NTUP_PER_BUCKET			10
+
+/*
+ * Prime numbers that we like to use as nbuckets values.  Hash values are
+ * 32 bits wide, so there is no use for more buckets than the largest prime
+ * below 2^32; where long is wide enough, we go up to that.
+ */
+static const long hprimes[] = {
+	1033, 2063, 4111, 8219, 16417, 32779, 65539, 131111,
+	262151, 524341, 1048589, 2097211, 4194329, 8388619, 16777289, 33554473,
+	67108913, 134217773, 268435463, 536870951, 1073741831
+#if LONG_MAX > INT_MAX
+	, 2147483659L, 4294967291L
+#endif
+};
+
+#define HJ_MAX_BUCKETS		(hprimes[lengthof(hprimes) - 1])
+
+/*
+ * The planner only needs int-sized answers; the executor uses
+ * ExecChooseHashTableSizeMem, which can size tables past 2^31 buckets.
+ */
+void
+ExecChooseHashTableSize(double ntuples, int tupwidth,
+						int *numbuckets,
+						int *numbatches)
+{
+	long		nbuckets;
+
+	/*
+	 * Target in-memory hashtable size is work_mem kilobytes.
+	 */
+	ExecChooseHashTableSizeMem(ntuples, tupwidth, work_mem * 1024L,
+							   &nbuckets, numbatches);
+	*numbuckets = (int) Min(nbuckets, INT_MAX);
+}
+
+/*
+ * ExecChooseHashTableSizeMem
+ *		the same for a table allowed hash_table_bytes bytes
+ */
+static void
+ExecChooseHashTableSizeMem(double ntuples, int tupwidth,
+						   long hash_table_bytes,
+						   long *numbuckets, int *numbatches)
+{
+	int			tupsize;
+	double		inner_rel_bytes;
+	int			nbatch;
+	long		nbuckets;
+	int			i;
+
+	/* Force a plausible relation size if no info */
+	if (ntuples <= 0.0)
+		ntuples = 1000.0;
+
+	/*
+	 * Estimate tupsize based on footprint of tuple in hashtable... note this
+	 * does not allow for any palloc overhead.	The manipulations of spaceUsed
+	 * don't count palloc overhead either.
+	 */
+	tupsize = MAXALIGN(sizeof(HashJoinTupleData)) +
+		MAXALIGN(sizeof(HeapTupleHeaderData)) +
+		MAXALIGN(tupwidth);
+	inner_rel_bytes = ntuples * tupsize;
+
+	/*
+	 * Set nbuckets to achieve an average bucket load of NTUP_PER_BUCKET when
+	 * memory is filled.  Set nbatch to the smallest power of 2 that appears
+	 * sufficient.
+	 */
+	if (inner_rel_bytes > hash_table_bytes)
+	{
+		/* We'll need multiple batches */
+		long		lbuckets;
+		double		dbatch;
+		int			minbatch;
+
+		lbuckets = (hash_table_bytes / tupsize) / NTUP_PER_BUCKET;
+		lbuckets = Min(lbuckets, HJ_MAX_BUCKETS);
+		nbuckets = lbuckets;
+
+		dbatch = ceil(inner_rel_bytes / hash_table_bytes);
+		dbatch = Min(dbatch, INT_MAX / 2);
+		minbatch = (int) dbatch;
+		nbatch = 2;
+		while (nbatch < minbatch)
+			nbatch <<= 1;
+	}
+	else
+	{
+		/* We expect the hashtable to fit in memory */
+		double		dbuckets;
+
+		dbuckets = ceil(ntuples / NTUP_PER_BUCKET);
+		dbuckets = Min(dbuckets, (double) HJ_MAX_BUCKETS);
+		nbuckets = (long) dbuckets;
+
+		nbatch = 1;
+	}
+
+	/*
+	 * We want nbuckets to be prime so as to avoid having bucket and batch
+	 * numbers depend on only some bits of the hash code.  Choose the next
+	 * larger prime from the list in hprimes[].  (This also enforces that
+	 * nbuckets is not very small, by the simple expedient of not putting any
+	 * very small entries in hprimes[].)
+	 */
+	for (i = 0; i < (int) lengthof(hprimes); i++)
+	{
+		if (hprimes[i] >= nbuckets)
+		{
+			nbuckets = hprimes[i];
+			break;
+		}
+	}
+
+	*numbuckets = nbuckets;
+	*numbatches = nbatch;
+}
+
+/*
+ * Compute the number of blocks for a hash table's Bloom filter.
+ *
+ * ExecChooseHashTableSize picks nbuckets for an average bucket load of
+ * NTUP_PER_BUCKET when memory is full, so that is the number of tuples the
+ * filter has to describe.  We aim for about HJ_BLOOM_BITS_PER_TUPLE bits per
+ * tuple, which keeps the false positive rate of a blocked filter with eight
+ * bits set per key at a few percent, but never spend more than
+ * 1/HJ_BLOOM_MEM_FRACTION of work_mem on it.
+ */
+#define HJ_BLOOM_BITS_PER_TUPLE		10
+#define HJ_BLOOM_MEM_FRACTION		8
+
+static uint32
+ExecChooseHashBloomSize(long nbuckets)
+{
+	double		nbits;
+	double		maxblocks;
+	uint32		nblocks;
+
+	nbits = (double) nbuckets * NTUP_PER_BUCKET * HJ_BLOOM_BITS_PER_TUPLE;
+	maxblocks = (work_mem * 1024.0 / HJ_BLOOM_MEM_FRACTION) /
+		(HJ_BLOOM_BLOCK_WORDS * sizeof(uint32));
+	/* it is a single palloc, however large work_mem is */
+	maxblocks = Min(maxblocks,
+					(double) MaxAllocSize /
+					(HJ_BLOOM_BLOCK_WORDS * sizeof(uint32)));
+
+	/* round down to a power of 2 that fits both limits, but at least 1 */
+	nblocks = 1;
+	while ((double) nblocks * 2 * HJ_BLOOM_BLOCK_WORDS * 32 <= nbits &&
+		   (double) nblocks * 2 <= maxblocks &&
+		   nblocks < ((uint32) 1 << 30))
+		nblocks <<= 1;
+
+	return nblocks;
+}
+
+/*
+ * Decide whether the input of a hashjoin should be hashed with late
+ * materialization, given the estimated size of the relation to be hashed
+ * and the estimated number of join output rows.  Only the join key columns
+ * and the tuple's TID are kept in the hash table; every emitted match has
+ * to refetch the full tuple from the heap.  That is a win only for wide
+ * tuples that would not fit in work_mem anyway, and only if few of the
+ * stored tuples are expected to ever be fetched back.
+ *
+ * This is exported so that the planner's createplan.c can use it.
+ */
+
+/* Minimum estimated tuple width for late materialization */
+#define LATEMAT_MIN_WIDTH		256
+
+/* Maximum number of expected refetches, as a fraction of stored tuples */
+#define LATEMAT_MAX_FETCH_FRAC	0.2
+
+bool
+ExecChooseHashLateMaterialization(double ntuples, int tupwidth,
+								  double nmatches)
+{
+	double		tuple_bytes;
+
+	if (tupwidth < LATEMAT_MIN_WIDTH || ntuples <= 0.0)
+		return false;
+
+	/* No point if the full tuples fit in memory anyway */
+	tuple_bytes = ntuples * (MAXALIGN(sizeof(HashJoinTupleData)) +
+							 MAXALIGN(sizeof(HeapTupleHeaderData)) +
+							 MAXALIGN(tupwidth));
+	if (tuple_bytes <= work_mem * 1024.0)
+		return false;
+
+	return nmatches <= ntuples * LATEMAT_MAX_FETCH_FRAC;
+}
+
+/*
+ * ExecHashLateMaterialize
+ *		switch a hash table over to late materialization, if the estimates
+ *		favor it and the Hash node's input can support it
+ *
+ * The input must be a SeqScan or IndexScan that hands back unprojected heap
+ * tuples, so that t_self identifies the tuple; create_hashjoin_plan leaves
+ * the physical tlist in place for exactly those inputs.  The hash keys must
+ * be plain user columns of the scanned relation.
+ */
+void
+ExecHashLateMaterialize(HashJoinTable hashtable, HashState *hashstate,
+						double nmatches)
+{
+	PlanState  *child = outerPlanState(hashstate);
+	Plan	   *childPlan = child->plan;
+	TupleDesc	tupdesc;
+	List	   *keyexprs = NIL;
+	List	   *vars;
+	ListCell   *l;
+	bool	   *keep;
+	MemoryContext oldcxt;
+
+	if (!ExecChooseHashLateMaterialization(childPlan->plan_rows,
+										   childPlan->plan_width,
+										   nmatches))
+		return;
+	if (!IsA(child, SeqScanState) && !IsA(child, IndexScanState))
+		return;
+	if (child->ps_ProjInfo != NULL)
+		return;
+
+	foreach(l, hashstate->hashkeys)
+		keyexprs = lappend(keyexprs, ((ExprState *) lfirst(l))->expr);
+	vars = pull_var_clause((Node *) keyexprs, false);
+
+	tupdesc = ExecGetResultType(child);
+
+	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+
+	keep = (bool *) palloc0(tupdesc->natts * sizeof(bool));
+	foreach(l, vars)
+	{
+		Var		   *var = (Var *) lfirst(l);
+
+		if (var->varattno <= 0 || var->varattno > tupdesc->natts)
+		{
+			/* system column or whole-row reference: can't strip */
+			MemoryContextSwitchTo(oldcxt);
+			pfree(keep);
+			return;
+		}
+		keep[var->varattno - 1] = true;
+	}
+
+	hashtable->lateRel = ((ScanState *) child)->ss_currentRelation;
+	hashtable->lateTupDesc = tupdesc;
+	hashtable->lateKeepAttr = keep;
+	hashtable->lateValues = (Datum *) palloc(tupdesc->natts * sizeof(Datum));
+	hashtable->lateNulls = (char *) palloc(tupdesc->natts * sizeof(char));
+
+	MemoryContextSwitchTo(oldcxt);
+
+#ifdef HJDEBUG
+	printf("Late materialization enabled for relation %u\n",
+		   RelationGetRelid(hashtable->lateRel));
+#endif
+}
+
+/*
+ * ExecHashLateTuple
+ *		build the stripped-down copy of a scan tuple that late
+ *		materialization stores: key columns and t_self only
+ *
+ * The result is palloc'd in the caller's context.
+ */
+static HeapTuple
+ExecHashLateTuple(HashJoinTable hashtable, HeapTuple tuple)
+{
+	TupleDesc	tupdesc = hashtable->lateTupDesc;
+	HeapTuple	result;
+	int			i;
+
+	heap_deformtuple(tuple, tupdesc,
+					 hashtable->lateValues, hashtable->lateNulls);
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		if (!hashtable->lateKeepAttr[i])
+			hashtable->lateNulls[i] = 'n';
+	}
+	result = heap_formtuple(tupdesc,
+							hashtable->lateValues, hashtable->lateNulls);
+	result->t_self = tuple->t_self;
+	result->t_tableOid = tuple->t_tableOid;
+
+	return result;
+}
+
+/*
+ * ExecHashGetMCVHashValues
+ *		collect the hash values of the most common values of a Hash node's
+ *		join key, as recorded in pg_statistic for the scanned relation
+ *
+ * Only a single-column key that is a plain column of a base-relation scan
+ * qualifies.  MCVs less common than SKEW_MIN_FREQUENCY are not worth a skew
+ * bucket.  At most maxvalues hash values are stored into hashvalues[], and
+ * their frequencies into freqs[]; the number stored is returned.
+ */
+static int
+ExecHashGetMCVHashValues(HashJoinTable hashtable, HashState *hashstate,
+						 uint32 *hashvalues, float4 *freqs, int maxvalues)
+{
+	PlanState  *child = outerPlanState(hashstate);
+	ExprState  *keystate;
+	Var		   *var;
+	TargetEntry *tle;
+	HeapTuple	statsTuple;
+	Datum	   *values;
+	int			nvalues;
+	float4	   *numbers;
+	int			nnumbers;
+	int			nfound = 0;
+	int			i;
+
+	if (list_length(hashstate->hashkeys) != 1)
+		return 0;
+	if (!IsA(child, SeqScanState) && !IsA(child, IndexScanState) &&
+		!IsA(child, BitmapHeapScanState))
+		return 0;
+
+	/* the key must be a column of the scan's output... */
+	keystate = (ExprState *) linitial(hashstate->hashkeys);
+	var = (Var *) keystate->expr;
+	if (!IsA(var, Var) || var->varattno <= 0)
+		return 0;
+
+	/* ... which in turn must be a user column of the scanned relation */
+	tle = get_tle_by_resno(child->plan->targetlist, var->varattno);
+	if (tle == NULL || !IsA(tle->expr, Var))
+		return 0;
+	var = (Var *) tle->expr;
+	if (var->varattno <= 0)
+		return 0;
+
+	statsTuple = SearchSysCache(STATRELATT,
+								ObjectIdGetDatum(RelationGetRelid(((ScanState *) child)->ss_currentRelation)),
+								Int16GetDatum(var->varattno),
+								0, 0);
+	if (!HeapTupleIsValid(statsTuple))
+		return 0;
+
+	if (get_attstatsslot(statsTuple, var->vartype, var->vartypmod,
+						 STATISTIC_KIND_MCV, InvalidOid,
+						 &values, &nvalues,
+						 &numbers, &nnumbers))
+	{
+		/* MCVs are sorted by decreasing frequency */
+		for (i = 0; i < nvalues && nfound < maxvalues; i++)
+		{
+			if (numbers[i] < SKEW_MIN_FREQUENCY)
+				break;
+			freqs[nfound] = numbers[i];
+			hashvalues[nfound++] =
+				DatumGetUInt32(FunctionCall1(&hashtable->hashfunctions[0],
+											 values[i]));
+		}
+		free_attstatsslot(var->vartype, values, nvalues, numbers, nnumbers);
+	}
+
+	ReleaseSysCache(statsTuple);
+
+	return nfound;
+}
+
+/*
+ * ExecHashBuildSkewHash
+ *		set up the skew buckets of both tables of a symmetric hash join
+ *
+ * The most common join key values are taken from the statistics of both
+ * inputs, so a key that is hot on either side gets a skew bucket, and the
+ * two tables get the same set of skew buckets.  That way a probe from
+ * either side for a hot key finds all of its matches in the skew bucket.
+ * The skew hash table and the tuples in it may use at most
+ * SKEW_WORK_MEM_PERCENT of each table's spaceAllowed, and count against
+ * spaceAllowed as well; see ExecHashRemoveNextSkewBucket.
+ */
+void
+ExecHashBuildSkewHash(HashJoinTable outtable, HashState *outnode,
+					  HashJoinTable intable, HashState *innode)
+{
+	uint32	   *hashvalues;
+	float4	   *freqs;
+	int			maxvalues;
+	int			nvalues;
+	int			side;
+	int			i;
+	int			j;
+
+	/*
+	 * Eviction from a sliding window relies on buckets being kept in
+	 * insertion order, which skew buckets don't do; and a window already
+	 * bounds how long a hot key's chain can get.
+	 */
+	if (outtable->windowSize > 0)
+		return;
+
+	/* clamp before narrowing to int; spaceAllowed may be many GB */
+	maxvalues = (int) Min((outtable->spaceAllowed / 100 * SKEW_WORK_MEM_PERCENT) /
+						  (2 * (sizeof(HashSkewBucket *) + SKEW_BUCKET_OVERHEAD)),
+						  (Size) (2 * (int) (1.0 / SKEW_MIN_FREQUENCY)));
+	if (maxvalues <= 0)
+		return;
+
+	hashvalues = (uint32 *) palloc(maxvalues * sizeof(uint32));
+	freqs = (float4 *) palloc(maxvalues * sizeof(float4));
+	nvalues = ExecHashGetMCVHashValues(outtable, outnode,
+									   hashvalues, freqs, maxvalues);
+	nvalues += ExecHashGetMCVHashValues(intable, innode,
+										hashvalues + nvalues,
+										freqs + nvalues,
+										maxvalues - nvalues);
+	if (nvalues == 0)
+	{
+		pfree(hashvalues);
+		pfree(freqs);
+		return;
+	}
+
+	/*
+	 * Merge the two inputs' MCV lists into one by decreasing frequency, so
+	 * that the buckets are created hottest first.  There are only a few
+	 * hundred at most, so a simple insertion sort will do.
+	 */
+	for (i = 1; i < nvalues; i++)
+	{
+		uint32		hashvalue = hashvalues[i];
+		float4		freq = freqs[i];
+
+		for (j = i; j > 0 && freqs[j - 1] < freq; j--)
+		{
+			hashvalues[j] = hashvalues[j - 1];
+			freqs[j] = freqs[j - 1];
+		}
+		hashvalues[j] = hashvalue;
+		freqs[j] = freq;
+	}
+
+	for (side = 0; side < 2; side++)
+	{
+		HashJoinTable hashtable = side ? intable : outtable;
+		MemoryContext oldcxt;
+		int			nbuckets;
+
+		/* Use twice as many slots as MCVs, so the lookup stays short */
+		nbuckets = 2;
+		while (nbuckets < nvalues * 2)
+			nbuckets <<= 1;
+
+		oldcxt = MemoryContextSwitchTo(hashtable->batchCxt);
+
+		hashtable->skewEnabled = true;
+		hashtable->skewBucketLen = nbuckets;
+		hashtable->skewBucket = (HashSkewBucket **)
+			palloc0(nbuckets * sizeof(HashSkewBucket *));
+		hashtable->skewBucketNums = (int *) palloc0(nvalues * sizeof(int));
+		hashtable->skewSpaceAllowed =
+			hashtable->spaceAllowed / 100 * SKEW_WORK_MEM_PERCENT;
+		hashtable->spaceUsedSkew = nbuckets * sizeof(HashSkewBucket *) +
+			nvalues * sizeof(int);
+		hashtable->spaceUsed += hashtable->spaceUsedSkew;
+
+		for (i = 0; i < nvalues; i++)
+		{
+			uint32		hashvalue = hashvalues[i];
+
+			/*
+			 * Find the slot for this hash value; a value that both inputs
+			 * (or two MCVs) share only gets one bucket.
+			 */
+			j = hashvalue & (nbuckets - 1);
+			while (hashtable->skewBucket[j] != NULL &&
+				   hashtable->skewBucket[j]->hashvalue != hashvalue)
+				j = (j + 1) & (nbuckets - 1);
+			if (hashtable->skewBucket[j] != NULL)
+				continue;
+
+			hashtable->skewBucket[j] = (HashSkewBucket *)
+				palloc(sizeof(HashSkewBucket));
+			hashtable->skewBucket[j]->hashvalue = hashvalue;
+			hashtable->skewBucket[j]->tuples = NULL;
+			hashtable->skewBucketNums[hashtable->nSkewBuckets] = j;
+			hashtable->nSkewBuckets++;
+			hashtable->spaceUsed += SKEW_BUCKET_OVERHEAD;
+			hashtable->spaceUsedSkew += SKEW_BUCKET_OVERHEAD;
+		}
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+#ifdef HJDEBUG
+	printf("Using %d skew buckets\n", intable->nSkewBuckets);
+#endif
+
+	pfree(hashvalues);
+	pfree(freqs);
+}
+
+/*
+ * ExecHashGetSkewBucket
+ *		Returns the index of the skew bucket for this hashvalue,
+ *		or INVALID_SKEW_BUCKET_NO if the hashvalue is not
+ *		associated with any active skew bucket.
+ */
+int
+ExecHashGetSkewBucket(HashJoinTable hashtable, uint32 hashvalue)
+{
+	int			bucket;
+
+	if (!hashtable->skewEnabled)
+		return INVALID_SKEW_BUCKET_NO;
+
+	bucket = hashvalue & (hashtable->skewBucketLen - 1);
+	while (hashtable->skewBucket[bucket] != NULL &&
+		   hashtable->skewBucket[bucket]->hashvalue != hashvalue)
+		bucket = (bucket + 1) & (hashtable->skewBucketLen - 1);
+
+	if (hashtable->skewBucket[bucket] != NULL)
+		return bucket;
+
+	return INVALID_SKEW_BUCKET_NO;
+}
+
+/*
+ * ExecHashRemoveNextSkewBucket
+ *		give up the coldest skew bucket of a table and of its partner
+ *
+ * Called when the skew buckets have outgrown skewSpaceAllowed.  Both tables
+ * drop the bucket together, since they must keep the same set of skew
+ * buckets (see ExecHashBuildSkewHash).  unprobed is the tuple whose
+ * insertion got us here, which hasn't probed the other table yet.
+ */
+static void
+ExecHashRemoveNextSkewBucket(HashJoinTable hashtable, HashJoinTuple unprobed)
+{
+	HashJoinTable partner = hashtable->partner;
+
+	ExecHashDropSkewBucket(hashtable, unprobed);
+	if (partner != NULL && partner->nSkewBuckets > 0)
+		ExecHashDropSkewBucket(partner, NULL);
+}
+
+/*
+ * ExecHashDropSkewBucket
+ *		remove one table's coldest skew bucket, moving its tuples back to
+ *		the main buckets or to the batch files
+ *
+ * The buckets were created hottest first, so the last one in
+ * skewBucketNums[] holds the least common of the MCVs.  Removing them in
+ * the reverse of the order they were created in also means that no
+ * remaining hash value's probe sequence runs through the freed slot, so it
+ * can simply be emptied.
+ *
+ * Every tuple in the bucket has already been joined with all of the other
+ * table's tuples of the same key, which are in its own skew bucket.  So a
+ * tuple whose batch is in memory is just relinked into its main bucket,
+ * and still counts in spaceUsed; one whose batch has been flushed goes to
+ * the batch files marked as joined, like any other tuple dumped during the
+ * first pass.  unprobed is different: it may only join the table's memory
+ * if new tuples of its batch still go there, and otherwise it is saved
+ * with the mark it would get on arrival (see ExecHashTableInsertTuple).
+ */
+static void
+ExecHashDropSkewBucket(HashJoinTable hashtable, HashJoinTuple unprobed)
+{
+	int			bucketToRemove;
+	HashSkewBucket *bucket;
+	HashJoinTuple hashTuple;
+
+	Assert(hashtable->nSkewBuckets > 0);
+	bucketToRemove = hashtable->skewBucketNums[hashtable->nSkewBuckets - 1];
+	bucket = hashtable->skewBucket[bucketToRemove];
+
+	hashTuple = bucket->tuples;
+	while (hashTuple != NULL)
+	{
+		HashJoinTuple nextHashTuple = hashTuple->next;
+		Size		tupleSize;
+		long		bucketno;
+		int			batchno;
+
+		tupleSize = MAXALIGN(sizeof(HashJoinTupleData)) + hashTuple->htup.t_len;
+		ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
+								  &bucketno, &batchno);
+		if (hashTuple == unprobed ?
+			HJ_BATCH_RESIDENT(hashtable, batchno) :
+			HJ_BATCH_IN_MEMORY(hashtable, batchno))
+		{
+			hashTuple->joined = false;
+			hashTuple->next = hashtable->buckets[bucketno];
+			hashtable->buckets[bucketno] = hashTuple;
+			if (hashtable->batchSpace != NULL)
+				hashtable->batchSpace[batchno] += tupleSize;
+			if (hashTuple == unprobed)
+				hashtable->newestTuple = hashTuple;
+		}
+		else
+		{
+			bool		joined = true;
+
+			if (hashTuple == unprobed)
+				joined = (hashtable->partner != NULL &&
+						  HJ_BATCH_IN_MEMORY(hashtable->partner, batchno));
+			ExecHashTableSaveTuple(hashtable, &hashTuple->htup,
+								   hashTuple->hashvalue, batchno, joined);
+			hashtable->spaceUsed -= tupleSize;
+			ExecHashArenaFree(hashtable, hashTuple);
+		}
+		hashtable->spaceUsedSkew -= tupleSize;
+
+		hashTuple = nextHashTuple;
+	}
+
+	hashtable->skewBucket[bucketToRemove] = NULL;
+	hashtable->nSkewBuckets--;
+	pfree(bucket);
+	hashtable->spaceUsed -= SKEW_BUCKET_OVERHEAD;
+	hashtable->spaceUsedSkew -= SKEW_BUCKET_OVERHEAD;
+
+	/* with no buckets left, don't bother looking them up any more */
+	if (hashtable->nSkewBuckets == 0)
+		hashtable->skewEnabled = false;
+
+#ifdef HJDEBUG
+	printf("Removed skew bucket %d, %d left\n",
+		   bucketToRemove, hashtable->nSkewBuckets);
+#endif
+}
+
+/*
+ * ExecHashStoreMatch
+ *		store a matching hashtable tuple into a slot so that the join can
+ *		check its remaining quals and project it
+ *
+ * Under late materialization the stored tuple only has the key columns, so
+ * we refetch the full tuple from the heap by TID.  The slot keeps the buffer
+ * pinned until it is cleared or reused.
+ */
+TupleTableSlot *
+ExecHashStoreMatch(HashJoinTable hashtable, HeapTuple tuple,
+				   TupleTableSlot *slot, EState *estate)
+{
+	Buffer		buffer;
+
+	if (hashtable->lateRel == NULL)
+		return ExecStoreTuple(tuple, slot, InvalidBuffer, false);
+
+	hashtable->lateTuple.t_self = tuple->t_self;
+	if (!heap_fetch(hashtable->lateRel, estate->es_snapshot,
+					&hashtable->lateTuple, &buffer, false, NULL))
+		elog(ERROR, "could not refetch tuple (%u,%u) of relation \"%s\" for hash join",
+			 ItemPointerGetBlockNumber(&tuple->t_self),
+			 ItemPointerGetOffsetNumber(&tuple->t_self),
+			 RelationGetRelationName(hashtable->lateRel));
+
+	slot = ExecStoreTuple(&hashtable->lateTuple, slot, buffer, false);
+	ReleaseBuffer(buffer);
+
+	return slot;
+}
+
+
+/* ----------------------------------------------------------------
+ *		ExecHashTableDestroy
+ *
+ *		destroy a hash table
+ * ----------------------------------------------------------------
+ */
+void
+ExecHashTableDestroy(HashJoinTable hashtable)
+{
+	int			i;
+
+	/*
+	 * Make sure all the temp files are closed.  We skip batch 0, since it
+	 * can't have any temp files (and the arrays might not even exist if
+	 * nbatch is only 1).
+	 */
+	for (i = 1; i < hashtable->nbatch; i++)
+	{
+		if (hashtable->unjoinedBatchFile[i])
+			ExecHashBatchFileClose(hashtable->unjoinedBatchFile[i]);
+		if (hashtable->joinedBatchFile[i])
+			ExecHashBatchFileClose(hashtable->joinedBatchFile[i]);
+	}
+
+	if (hashtable->arena != NULL)
+		ExecHashArenaDestroy(hashtable->arena);
+	if (hashtable->bucketArena != NULL)
+		ExecHashArenaDestroy(hashtable->bucketArena);
+
+	/* Release working memory (batchCxt is a child, so it goes away too) */
+	MemoryContextDelete(hashtable->hashCxt);
+
+	/* And drop the control block */
+	if (hashtable->persistent)
+		pfree(hashtable->hashfunctions);
+	pfree(hashtable);
+}
+
+/*
+ * ExecHashIncreaseNumBatches
+ *		increase the original number of batches in order to reduce
+ *		current memory consumption
+ *
+ * CSI3130: both tables of a symmetric join partition their inputs the same
+ * way, so they always double nbatch together, and each dumps the tuples
+ * that have left the current batch into its own files.  During the first
+ * pass, every tuple in memory has already been joined with every tuple of
+ * the other table's memory that it matches (whichever of the two arrived
+ * later probed the other), except for the tuple whose insertion got us
+ * here, which hasn't probed yet.  The dumped tuples are marked accordingly
+ * (see HashJoinTupleData), so the batch pass doesn't join such pairs a
+ * second time.  In the batch pass, dumped tuples keep their marks.
+ *
+ * During the first pass, all of this is left to ExecHashFlushBatches.
+ */
+static void
+ExecHashIncreaseNumBatches(HashJoinTable hashtable)
+{
+	HashJoinTable partner = hashtable->partner;
+	long		ninmemory;
+	long		nfreed;
+
+	/* a table that may go on in a memory-mapped file does so first */
+	if (hashtable->mmapSize > 0 && ExecHashMapArena(hashtable) &&
+		hashtable->spaceUsed <= hashtable->spaceAllowed)
+		return;
+
+	/*
+	 * A checkpointed join's tables outgrowing work_mem stop being
+	 * checkpointed, and may batch from now on; the join notices and gives
+	 * up its checkpoint file.  Leave the batching to the next insertion,
+	 * so that a join still loading its checkpoint can fail before any.
+	 * (A windowed table never batches; its window bounds its size.)
+	 */
+	if (hashtable->checkpointed && hashtable->windowSize == 0)
+	{
+		hashtable->checkpointed = false;
+		hashtable->growEnabled = true;
+		if (partner != NULL)
+		{
+			partner->checkpointed = false;
+			partner->growEnabled = true;
+		}
+		return;
+	}
+
+	/* do nothing if we've decided to shut off growth */
+	if (!hashtable->growEnabled)
+		return;
+
+	/* in the first pass, we choose which batches to give up */
+	if (hashtable->curbatch == 0)
+	{
+		ExecHashFlushBatches(hashtable);
+		return;
+	}
+
+	if (!ExecHashSplitBatches(hashtable))
+		return;
+
+	/*
+	 * Scan through the existing hash table entries and dump out any that are
+	 * no longer of the current batch.
+	 */
+	nfreed = ExecHashDumpBatches(hashtable, hashtable->newestTuple,
+								 &ninmemory);
+	if (partner != NULL)
+	{
+		long		partnerinmemory;
+
+		(void) ExecHashDumpBatches(partner, NULL, &partnerinmemory);
+	}
+
+#ifdef HJDEBUG
+	printf("Freed %ld of %ld tuples, space now %lu\n",
+		   nfreed, ninmemory, (unsigned long) hashtable->spaceUsed);
+#endif
+
+	/*
+	 * If we dumped out either all or none of the tuples in the table, disable
+	 * further expansion of nbatch.  This situation implies that we have
+	 * enough tuples of identical hashvalues to overflow spaceAllowed.
+	 * Increasing nbatch will not fix it since there's no way to subdivide the
+	 * group any more finely. We have to just gut it out and hope the server
+	 * has enough RAM.
+	 */
+	if (nfreed == 0 || nfreed == ninmemory)
+	{
+		hashtable->growEnabled = false;
+#ifdef HJDEBUG
+		printf("Disabling further increase of nbatch\n");
+#endif
+	}
+}
+
+/*
+ * ExecHashEnlargeBatchArrays
+ *		set a table's nbatch, enlarging its per-batch arrays to match
+ */
+static void
+ExecHashEnlargeBatchArrays(HashJoinTable hashtable, int nbatch)
+{
+	int			oldnbatch = hashtable->nbatch;
+	MemoryContext oldcxt;
+
+	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+
+	if (hashtable->unjoinedBatchFile == NULL)
+	{
+		/* we had no file arrays before */
+		hashtable->unjoinedBatchFile = (HashJoinBatchFile *)
+			palloc0(nbatch * sizeof(HashJoinBatchFile));
+		hashtable->joinedBatchFile = (HashJoinBatchFile *)
+			palloc0(nbatch * sizeof(HashJoinBatchFile));
+		hashtable->spillBytes = (double *)
+			palloc0(nbatch * sizeof(double));
+	}
+	else
+	{
+		/* enlarge arrays and zero out added entries */
+		hashtable->unjoinedBatchFile = (HashJoinBatchFile *)
+			repalloc(hashtable->unjoinedBatchFile,
+					 nbatch * sizeof(HashJoinBatchFile));
+		hashtable->joinedBatchFile = (HashJoinBatchFile *)
+			repalloc(hashtable->joinedBatchFile,
+					 nbatch * sizeof(HashJoinBatchFile));
+		hashtable->spillBytes = (double *)
+			repalloc(hashtable->spillBytes, nbatch * sizeof(double));
+		MemSet(hashtable->unjoinedBatchFile + oldnbatch, 0,
+			   (nbatch - oldnbatch) * sizeof(HashJoinBatchFile));
+		MemSet(hashtable->joinedBatchFile + oldnbatch, 0,
+			   (nbatch - oldnbatch) * sizeof(HashJoinBatchFile));
+		MemSet(hashtable->spillBytes + oldnbatch, 0,
+			   (nbatch - oldnbatch) * sizeof(double));
+	}
+
+	if (hashtable->batchResident == NULL)
+	{
+		/* until something is flushed, every batch is in memory */
+		hashtable->batchResident = (bool *) palloc(nbatch * sizeof(bool));
+		MemSet(hashtable->batchResident, true, nbatch * sizeof(bool));
+		hashtable->batchSpace = (Size *) palloc(nbatch * sizeof(Size));
+		hashtable->batchHits = (double *) palloc0(nbatch * sizeof(double));
+	}
+	else
+	{
+		int			i;
+
+		/*
+		 * Batch i splits into batches i, i + oldnbatch, ...; the new ones
+		 * take its residency and an even share of its hits.
+		 */
+		hashtable->batchResident = (bool *)
+			repalloc(hashtable->batchResident, nbatch * sizeof(bool));
+		hashtable->batchSpace = (Size *)
+			repalloc(hashtable->batchSpace, nbatch * sizeof(Size));
+		hashtable->batchHits = (double *)
+			repalloc(hashtable->batchHits, nbatch * sizeof(double));
+		for (i = nbatch - 1; i >= 0; i--)
+		{
+			hashtable->batchResident[i] =
+				hashtable->batchResident[i % oldnbatch];
+			hashtable->batchHits[i] = hashtable->batchHits[i % oldnbatch] *
+				oldnbatch / nbatch;
+		}
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	hashtable->nbatch = nbatch;
+	ExecHashCountBatchSpace(hashtable);
+}
+
+/*
+ * ExecHashSplitBatches
+ *		double the number of batches of a table and its partner
+ *
+ * Returns false if nbatch can't grow any more.
+ */
+static bool
+ExecHashSplitBatches(HashJoinTable hashtable)
+{
+	HashJoinTable partner = hashtable->partner;
+	int			oldnbatch = hashtable->nbatch;
+	int			nbatch;
+
+	/* safety check to avoid overflow */
+	if (oldnbatch > INT_MAX / 2)
+		return false;
+
+	nbatch = oldnbatch * 2;
+	Assert(nbatch > 1);
+
+#ifdef HJDEBUG
+	printf("Increasing nbatch to %d because space = %lu\n",
+		   nbatch, (unsigned long) hashtable->spaceUsed);
+#endif
+
+	ExecHashEnlargeBatchArrays(hashtable, nbatch);
+	if (partner != NULL)
+	{
+		Assert(partner->nbatch == oldnbatch);
+		ExecHashEnlargeBatchArrays(partner, nbatch);
+	}
+
+	return true;
+}
+
+/*
+ * ExecHashCountBatchSpace
+ *		recount the bytes each batch takes up in a table's buckets
+ *
+ * batchSpace[] is kept up to date as tuples come and go, but when nbatch
+ * doubles, only the buckets can tell how each batch's tuples divide among
+ * the new ones.  That happens once per doubling, so the walk costs no more
+ * than the dump that follows it.  Skew tuples are not counted, since
+ * flushing a batch doesn't move them.
+ */
+static void
+ExecHashCountBatchSpace(HashJoinTable hashtable)
+{
+	Size	   *space = hashtable->batchSpace;
+	long		i;
+
+	MemSet(space, 0, hashtable->nbatch * sizeof(Size));
+	for (i = 0; i < hashtable->nbuckets; i++)
+	{
+		HashJoinTuple tuple;
+
+		for (tuple = hashtable->buckets[i]; tuple != NULL; tuple = tuple->next)
+		{
+			long		bucketno;
+			int			batchno;
+
+			ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
+									  &bucketno, &batchno);
+			space[batchno] +=
+				MAXALIGN(sizeof(HashJoinTupleData)) + tuple->htup.t_len;
+		}
+	}
+}
+
+/*
+ * ExecHashFlushBatches
+ *		make room in a table during the first pass by flushing whole batches
+ *
+ * Each table's batches 1..nbatch-1 start out in memory.  When the table
+ * fills up, we pick batches to flush to its files until its remaining
+ * tuples fit in spaceAllowed.  Only this table's side of a batch is
+ * flushed: the partner keeps its own tuples of the batch in memory, so our
+ * input's later tuples of the batch still find their matches there right
+ * away, and from then on saves its new tuples of the batch to its files
+ * (see HJ_BATCH_RESIDENT).  The partner flushes its side when it runs out
+ * of room itself.  Batch 0 always stays; if no other batch is left to
+ * flush, nbatch doubles first to split some off it.
+ *
+ * hashjoin_flush_policy picks the victims from this table's own counts:
+ * HJ_FLUSH_LARGEST frees as much memory per batch as possible, and
+ * HJ_FLUSH_ADAPTIVE gives up the batches whose tuples have found the
+ * fewest matches per byte so far (counted by ExecScanHashBucket), which
+ * are the ones whose future matches are cheapest to defer to the batch
+ * pass.
+ */
+static void
+ExecHashFlushBatches(HashJoinTable hashtable)
+{
+	Size	   *space = hashtable->batchSpace;
+	bool		split = false;
+	Size		spaceUsed;
+	Size		freed;
+	long		ninmemory;
+	int			nchosen;
+	int			i;
+
+	Assert(hashtable->curbatch == 0);
+
+	for (;;)
+	{
+		spaceUsed = hashtable->spaceUsed;
+		nchosen = 0;
+		while (spaceUsed > hashtable->spaceAllowed)
+		{
+			int			victim = -1;
+			double		best = 0;
+
+			for (i = 1; i < hashtable->nbatch; i++)
+			{
+				double		score;
+
+				if (!hashtable->batchResident[i] || space[i] == 0)
+					continue;
+				if (hashjoin_flush_policy == HJ_FLUSH_ADAPTIVE)
+				{
+					/* fewest matches per byte freed; lower is better */
+					score = -(hashtable->batchHits[i] + 1) / space[i];
+				}
+				else
+					score = space[i];
+				if (victim < 0 || score > best)
+				{
+					victim = i;
+					best = score;
+				}
+			}
+			if (victim < 0)
+				break;
+
+			hashtable->batchResident[victim] = false;
+			hashtable->batchesFlushed++;
+			spaceUsed -= space[victim];
+			nchosen++;
+
+			elog(DEBUG1, "hash join: flushing batch %d of %d (%lu bytes, %.0f matches)",
+				 victim, hashtable->nbatch, (unsigned long) space[victim],
+				 hashtable->batchHits[victim]);
+		}
+
+		/* if nothing could go, try once to split batch 0 and look again */
+		if (nchosen > 0 || split)
+			break;
+		if (!ExecHashSplitBatches(hashtable))
+			break;
+		split = true;
+	}
+
+	/* now dump the tuples of the batches that were chosen */
+	spaceUsed = hashtable->spaceUsed;
+	(void) ExecHashDumpBatches(hashtable, hashtable->newestTuple, &ninmemory);
+	freed = spaceUsed - hashtable->spaceUsed;
+	hashtable->flushedSpace += freed;
+
+	/*
+	 * If we couldn't free anything, the table is down to tuples that no
+	 * number of batches can separate from batch 0, so stop trying.
+	 */
+	if (freed == 0)
+	{
+		hashtable->growEnabled = false;
+#ifdef HJDEBUG
+		printf("Disabling further increase of nbatch\n");
+#endif
+	}
+}
+
+/*
+ * ExecHashTableEndFirstPass
+ *		dump the tuples a table still holds of batches its partner flushed
+ *
+ * Called for both tables once both inputs have ended.  A batch still in
+ * memory on both sides is done: all of its pairs have been produced, and
+ * nothing of it was saved.  But a batch the partner flushed has saved
+ * tuples that must meet ours in the batch pass, so our side of it goes to
+ * the files too, marked as joined.
+ */
+void
+ExecHashTableEndFirstPass(HashJoinTable hashtable)
+{
+	HashJoinTable partner = hashtable->partner;
+	bool		anyflushed = false;
+	long		ninmemory;
+	int			i;
+
+	Assert(hashtable->curbatch == 0);
+
+	if (partner == NULL || hashtable->batchResident == NULL)
+		return;
+
+	for (i = 1; i < hashtable->nbatch; i++)
+	{
+		if (hashtable->batchResident[i] && !partner->batchResident[i])
+		{
+			hashtable->batchResident[i] = false;
+			anyflushed = true;
+		}
+	}
+	if (anyflushed)
+		(void) ExecHashDumpBatches(hashtable, NULL, &ninmemory);
+}
+
+/*
+ * ExecHashDumpBatches
+ *		dump the in-memory tuples whose batch is no longer kept in memory
+ *
+ * unprobed is the tuple (if any) that hasn't probed the other table yet.
+ * In the first pass, every other tuple has joined with all of the other
+ * table's tuples of its batch in memory, and is dumped marked as joined;
+ * unprobed is marked so only if the other table still has the batch in
+ * memory for it to probe.  Returns the number of tuples dumped, and the
+ * number there were in memory at *ninmemory.  Skew tuples stay where they
+ * are.
+ */
+static long
+ExecHashDumpBatches(HashJoinTable hashtable, HashJoinTuple unprobed,
+					long *ninmemory)
+{
+	int			curbatch = hashtable->curbatch;
+	long		nfreed = 0;
+	long		i;
+
+	*ninmemory = 0;
+
+	for (i = 0; i < hashtable->nbuckets; i++)
+	{
+		HashJoinTuple prevtuple;
+		HashJoinTuple tuple;
+
+		prevtuple = NULL;
+		tuple = hashtable->buckets[i];
+
+		while (tuple != NULL)
+		{
+			/* save link in case we delete */
+			HashJoinTuple nexttuple = tuple->next;
+			long		bucketno;
+			int			batchno;
+
+			(*ninmemory)++;
+			ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
+									  &bucketno, &batchno);
+			Assert(bucketno == i);
+			if (HJ_BATCH_IN_MEMORY(hashtable, batchno))
+			{
+				/* keep tuple */
+				prevtuple = tuple;
+			}
+			else
+			{
+				Size		tupleSize;
+				bool		joined;
+
+				/* dump it out */
+				Assert(batchno > curbatch);
+				if (curbatch > 0)
+					joined = tuple->joined;
+				else if (tuple != unprobed)
+					joined = true;
+				else
+					joined = (hashtable->partner != NULL &&
+							  HJ_BATCH_IN_MEMORY(hashtable->partner, batchno));
+				ExecHashTableSaveTuple(hashtable, &tuple->htup,
+									   tuple->hashvalue, batchno, joined);
+				/* and remove from hash table */
+				if (prevtuple)
+					prevtuple->next = nexttuple;
+				else
+					hashtable->buckets[i] = nexttuple;
+				/* prevtuple doesn't change */
+				tupleSize =
+					MAXALIGN(sizeof(HashJoinTupleData)) + tuple->htup.t_len;
+				hashtable->spaceUsed -= tupleSize;
+				if (hashtable->batchSpace != NULL)
+					hashtable->batchSpace[batchno] -= tupleSize;
+				if (tuple == hashtable->newestTuple)
+					hashtable->newestTuple = NULL;
+				ExecHashArenaFree(hashtable, tuple);
+				nfreed++;
+			}
+
+			tuple = nexttuple;
+		}
+	}
+
+	return nfreed;
+}
+
+/*
+ * ExecHashTableLink
+ *		make the two tables of a symmetric join partners
+ *
+ * The batch pass joins batch i of one input with batch i of the other, so
+ * both inputs must be split into batches the same way: the tables get the
+ * same nbuckets and nbatch (the larger of each), and from then on change
+ * nbatch only together.  Must be called while both tables are still empty.
+ */
+void
+ExecHashTableLink(HashJoinTable outtable, HashJoinTable intable)
+{
+	int			side;
+
+	outtable->partner = intable;
+	intable->partner = outtable;
+
+	for (side = 0; side < 2; side++)
+	{
+		HashJoinTable hashtable = side ? intable : outtable;
+		HashJoinTable other = side ? outtable : intable;
+		MemoryContext oldcxt;
+
+		if (hashtable->nbuckets < other->nbuckets)
+		{
+			oldcxt = MemoryContextSwitchTo(hashtable->batchCxt);
+			ExecHashArenaFree(hashtable, hashtable->buckets);
+			hashtable->nbuckets = other->nbuckets;
+			hashtable->buckets = ExecHashAllocBuckets(hashtable,
+													  hashtable->nbuckets);
+			if (hashtable->windowSize > 0)
+			{
+				pfree(hashtable->bucketTails);
+				hashtable->bucketTails = (HashJoinTuple *)
+					palloc0(hashtable->nbuckets * sizeof(HashJoinTuple));
+			}
+			MemoryContextSwitchTo(oldcxt);
+		}
+
+		if (hashtable->nbatch < other->nbatch)
+			ExecHashEnlargeBatchArrays(hashtable, other->nbatch);
+	}
+
+	/* a table that can't batch keeps its partner from batching, too */
+	if (!outtable->growEnabled || !intable->growEnabled)
+	{
+		Assert(outtable->nbatch == 1);
+		outtable->growEnabled = false;
+		intable->growEnabled = false;
+	}
+}
+
+/*
+ * ExecHashTableInsert
+ *		insert a tuple into the hash table depending on the hash value
+ *		it may just go to a temp file for later batches
+ */
+void
+ExecHashTableInsert(HashJoinTable hashtable,
+					HeapTuple tuple,
+					uint32 hashvalue)
+{
+	ExecHashTableInsertTuple(hashtable, tuple, hashvalue, false);
+}
+
+/*
+ * ExecHashTableReload
+ *		insert a tuple read back from one of the table's batch files
+ *
+ * joined is the mark the tuple was saved with; see HashJoinTupleData.
+ */
+void
+ExecHashTableReload(HashJoinTable hashtable, HeapTuple tuple,
+					uint32 hashvalue, bool joined)
+{
+	ExecHashTableInsertTuple(hashtable, tuple, hashvalue, joined);
+}
+
+static void
+ExecHashTableInsertTuple(HashJoinTable hashtable, HeapTuple tuple,
+						 uint32 hashvalue, bool joined)
+{
+	long		bucketno;
+	int			batchno;
+	int			skewbucket;
+
+	/*
+	 * a tuple with one of the most common key values goes to its skew
+	 * bucket, which stays in memory for as long as it fits in
+	 * skewSpaceAllowed
+	 */
+	skewbucket = ExecHashGetSkewBucket(hashtable, hashvalue);
+	if (skewbucket != INVALID_SKEW_BUCKET_NO)
+	{
+		HashJoinTuple hashTuple;
+		int			hashTupleSize;
+
+		hashTuple = ExecHashCopyTuple(hashtable, tuple, hashvalue,
+									  &hashTupleSize);
+		hashTuple->next = hashtable->skewBucket[skewbucket]->tuples;
+		hashtable->skewBucket[skewbucket]->tuples = hashTuple;
+		/* keep the filter complete; it doubles as the runtime join filter */
+		ExecHashBloomAdd(hashtable, hashvalue);
+		hashtable->spaceUsed += hashTupleSize;
+		hashtable->spaceUsedSkew += hashTupleSize;
+		hashtable->skewTuples += 1;
+
+		/*
+		 * No tuple in buckets[] is unprobed now, unless the bucket this one
+		 * went into is given up and it moves there
+		 */
+		hashtable->newestTuple = NULL;
+		while (hashtable->spaceUsedSkew > hashtable->skewSpaceAllowed &&
+			   hashtable->nSkewBuckets > 0)
+			ExecHashRemoveNextSkewBucket(hashtable, hashTuple);
+		if (hashtable->spaceUsed > hashtable->spaceAllowed)
+			ExecHashIncreaseNumBatches(hashtable);
+		return;
+	}
+
+	ExecHashGetBucketAndBatch(hashtable, hashvalue,
+							  &bucketno, &batchno);
+
+	/*
+	 * decide whether to put the tuple in the hash table or a temp file
+	 */
+	if (HJ_BATCH_RESIDENT(hashtable, batchno))
+	{
+		/*
+		 * put the tuple in hash table
+		 */
+		HashJoinTuple hashTuple;
+		int			hashTupleSize;
+
+		hashTuple = ExecHashCopyTuple(hashtable, tuple, hashvalue,
+									  &hashTupleSize);
+		hashTuple->joined = joined;
+		if (hashtable->windowSize > 0)
+			ExecHashWindowAdd(hashtable, hashTuple, bucketno);
+		else
+		{
+			hashTuple->next = hashtable->buckets[bucketno];
+			hashtable->buckets[bucketno] = hashTuple;
+		}
+		ExecHashBloomAdd(hashtable, hashvalue);
+		hashtable->spaceUsed += hashTupleSize;
+		if (hashtable->batchSpace != NULL)
+			hashtable->batchSpace[batchno] += hashTupleSize;
+		hashtable->newestTuple = hashTuple;
+		if (hashtable->spaceUsed > hashtable->spaceAllowed)
+			ExecHashIncreaseNumBatches(hashtable);
+	}
+	else
+	{
+		/*
+		 * put the tuple into a temp file for later batches.  In the first
+		 * pass, the other table may still have its side of the batch in
+		 * memory; the tuple is about to probe that, so it's saved as
+		 * joined.
+		 */
+		Assert(batchno > hashtable->curbatch);
+		if (hashtable->curbatch == 0 && hashtable->partner != NULL &&
+			HJ_BATCH_IN_MEMORY(hashtable->partner, batchno))
+			joined = true;
+		ExecHashTableSaveTuple(hashtable, tuple, hashvalue, batchno, joined);
+
+		/*
+		 * During the first pass the filter covers the spilled tuples too,
+		 * so that as a runtime join filter it is right for every batch.
+		 */
+		if (hashtable->curbatch == 0)
+			ExecHashBloomAdd(hashtable, hashvalue);
+	}
+}
+
+/*
+ * ExecHashTableSaveTuple
+ *		save a tuple of this table's input to the file of the given batch
+ *
+ * A table's unjoinedBatchFile[] holds the tuples that haven't been joined
+ * with anything yet, and its joinedBatchFile[] those that were joined with
+ * the other table's in-memory tuples before being dumped; see
+ * ExecHashIncreaseNumBatches.
+ */
+void
+ExecHashTableSaveTuple(HashJoinTable hashtable, HeapTuple tuple,
+					   uint32 hashvalue, int batchno, bool joined)
+{
+	if (joined)
+		ExecHashBatchFileWrite(&hashtable->joinedBatchFile[batchno],
+							   &hashtable->spillStats, tuple, hashvalue);
+	else
+		ExecHashBatchFileWrite(&hashtable->unjoinedBatchFile[batchno],
+							   &hashtable->spillStats, tuple, hashvalue);
+	hashtable->spillBytes[batchno] += HJ_SPILL_RECORD_SIZE(tuple->t_len);
+}
+
+/*
+ * ExecHashBatchFileWrite
+ *		save a tuple to a batch file, creating the file if *fileptr is NULL
+ *
+ * The file's I/O will be counted in *stats.
+ *
+ * Note: it is important always to call this in the regular executor
+ * context, not in a shorter-lived context; else the temp file buffers
+ * will get messed up.
+ */
+void
+ExecHashBatchFileWrite(HashJoinBatchFile *fileptr, HashJoinSpillStats *stats,
+					   HeapTuple tuple, uint32 hashvalue)
+{
+	HashJoinBatchFile file = *fileptr;
+	HashJoinSpillRecord *rec;
+	Size		len = HJ_SPILL_RECORD_SIZE(tuple->t_len);
+
+	if (file == NULL)
+	{
+		/* First write to this batch file, so open it. */
+		file = (HashJoinBatchFile) palloc(sizeof(HashJoinBatchFileData));
+		file->file = BufFileCreateTemp(false);
+		file->stats = stats;
+		file->compress = hashjoin_spill_compression;
+		file->reading = false;
+		file->bufsize = HJ_SPILL_BLOCK_SIZE;
+		file->buf = palloc(file->bufsize);
+		file->used = 0;
+		file->pos = 0;
+		file->ntuples = 0;
+		file->lzbuf = NULL;
+		if (file->compress)
+			file->lzbuf = palloc(PGLZ_MAX_OUTPUT(file->bufsize));
+		*fileptr = file;
+	}
+	Assert(!file->reading);
+
+	/* write out the block if it's full; a big tuple gets a block of its own */
+	if (file->used + len > file->bufsize)
+	{
+		if (file->ntuples > 0)
+			ExecHashBatchFileFlush(file);
+		if (len > file->bufsize)
+			ExecHashBatchFileEnlarge(file, len);
+	}
+
+	/* zero the whole record, so that padding doesn't go out uninitialized */
+	rec = (HashJoinSpillRecord *) (file->buf + file->used);
+	MemSet(rec, 0, len);
+	rec->hashvalue = hashvalue;
+	rec->t_len = tuple->t_len;
+	rec->t_self = tuple->t_self;
+	rec->t_tableOid = tuple->t_tableOid;
+	memcpy((char *) rec + MAXALIGN(sizeof(HashJoinSpillRecord)),
+		   tuple->t_data, tuple->t_len);
+	file->used += len;
+	file->ntuples++;
+}
+
+/*
+ * ExecHashBatchFileRead
+ *		read the next tuple from a batch file.  Return NULL if no more.
+ *
+ * The tuple points into the file's block buffer and is only good until
+ * the next read from the same file; nothing is palloc'd per tuple.  Its
+ * hash value is stored at *hashvalue.  The file must have been rewound
+ * first.
+ */
+HeapTuple
+ExecHashBatchFileRead(HashJoinBatchFile file, uint32 *hashvalue)
+{
+	HashJoinSpillRecord *rec;
+	HeapTuple	tuple = &file->tuple;
+
+	Assert(file->reading);
+	while (file->ntuples == 0)
+	{
+		if (!ExecHashBatchFileLoad(file))
+			return NULL;		/* end of file */
+	}
+
+	rec = (HashJoinSpillRecord *) (file->buf + file->pos);
+	if (file->pos + HJ_SPILL_RECORD_SIZE(rec->t_len) > file->used)
+		elog(ERROR, "hash-join temporary file block is corrupted");
+
+	tuple->t_len = rec->t_len;
+	tuple->t_self = rec->t_self;
+	tuple->t_tableOid = rec->t_tableOid;
+	tuple->t_datamcxt = NULL;
+	tuple->t_data = (HeapTupleHeader)
+		((char *) rec + MAXALIGN(sizeof(HashJoinSpillRecord)));
+	file->pos += HJ_SPILL_RECORD_SIZE(rec->t_len);
+	file->ntuples--;
+
+	*hashvalue = rec->hashvalue;
+	return tuple;
+}
+
+/*
+ * ExecHashBatchFileRewind
+ *		write out the last block of a batch file and rewind it for reading
+ */
+void
+ExecHashBatchFileRewind(HashJoinBatchFile file)
+{
+	if (!file->reading && file->ntuples > 0)
+		ExecHashBatchFileFlush(file);
+
+	if (BufFileSeek(file->file, 0, 0L, SEEK_SET))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not rewind hash-join temporary file: %m")));
+
+	file->reading = true;
+	file->used = 0;
+	file->pos = 0;
+	file->ntuples = 0;
+}
+
+/*
+ * ExecHashBatchFileClose
+ *		close a batch file and release its buffers
+ */
+void
+ExecHashBatchFileClose(HashJoinBatchFile file)
+{
+	BufFileClose(file->file);
+	pfree(file->buf);
+	if (file->lzbuf)
+		pfree(file->lzbuf);
+	pfree(file);
+}
+
+/*
+ * ExecHashBatchFileFlush
+ *		write out the block being filled
+ */
+static void
+ExecHashBatchFileFlush(HashJoinBatchFile file)
+{
+	HashJoinSpillBlock hdr;
+	char	   *data = file->buf;
+	struct timeval starttime;
+
+	hdr.ntuples = file->ntuples;
+	hdr.rawlen = file->used;
+	hdr.storedlen = file->used;
+	hdr.flags = 0;
+
+	if (file->compress)
+	{
+		PGLZ_Header *lz = (PGLZ_Header *) file->lzbuf;
+
+		/* pglz stores the data uncompressed if it can't do better */
+		pglz_compress(file->buf, file->used, lz, PGLZ_strategy_default);
+		if ((Size) lz->varsize < file->used)
+		{
+			data = file->lzbuf;
+			hdr.storedlen = lz->varsize;
+			hdr.flags |= HJ_SPILL_COMPRESSED;
+		}
+	}
+
+	INIT_CRC32(hdr.crc);
+	COMP_CRC32(hdr.crc, data, hdr.storedlen);
+	FIN_CRC32(hdr.crc);
+
+	if (file->stats->timing)
+		gettimeofday(&starttime, NULL);
+	if (BufFileWrite(file->file, (void *) &hdr, sizeof(HashJoinSpillBlock)) !=
+		sizeof(HashJoinSpillBlock) ||
+		BufFileWrite(file->file, (void *) data, hdr.storedlen) !=
+		(size_t) hdr.storedlen)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to hash-join temporary file: %m")));
+	if (file->stats->timing)
+		file->stats->writeTime += ExecHashSpillElapsed(&starttime);
+	file->stats->blocksWritten += 1;
+	file->stats->bytesWritten += sizeof(HashJoinSpillBlock) + hdr.storedlen;
+
+	file->used = 0;
+	file->ntuples = 0;
+}
+
+/*
+ * ExecHashBatchFileLoad
+ *		read the next block of a batch file into its buffer
+ *
+ * Returns false at end of file.
+ */
+static bool
+ExecHashBatchFileLoad(HashJoinBatchFile file)
+{
+	HashJoinSpillBlock hdr;
+	pg_crc32	crc;
+	char	   *data;
+	size_t		nread;
+	struct timeval starttime;
+
+	file->used = 0;
+	file->pos = 0;
+	file->ntuples = 0;
+
+	if (file->stats->timing)
+		gettimeofday(&starttime, NULL);
+	nread = BufFileRead(file->file, (void *) &hdr, sizeof(HashJoinSpillBlock));
+	if (nread == 0)
+	{
+		if (file->stats->timing)
+			file->stats->readTime += ExecHashSpillElapsed(&starttime);
+		return false;
+	}
+	if (nread != sizeof(HashJoinSpillBlock))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from hash-join temporary file: %m")));
+
+	if ((hdr.flags & HJ_SPILL_COMPRESSED) && !file->compress)
+		elog(ERROR, "hash-join temporary file block is corrupted");
+	if (hdr.rawlen > file->bufsize)
+		ExecHashBatchFileEnlarge(file, hdr.rawlen);
+	data = (hdr.flags & HJ_SPILL_COMPRESSED) ? file->lzbuf : file->buf;
+
+	nread = BufFileRead(file->file, (void *) data, hdr.storedlen);
+	if (nread != (size_t) hdr.storedlen)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from hash-join temporary file: %m")));
+	if (file->stats->timing)
+		file->stats->readTime += ExecHashSpillElapsed(&starttime);
+	file->stats->bytesRead += sizeof(HashJoinSpillBlock) + hdr.storedlen;
+
+	INIT_CRC32(crc);
+	COMP_CRC32(crc, data, hdr.storedlen);
+	FIN_CRC32(crc);
+	if (!EQ_CRC32(crc, hdr.crc))
+		elog(ERROR, "hash-join temporary file block is corrupted");
+
+	if (hdr.flags & HJ_SPILL_COMPRESSED)
+	{
+		if (PGLZ_RAW_SIZE((PGLZ_Header *) data) != hdr.rawlen)
+			elog(ERROR, "hash-join temporary file block is corrupted");
+		pglz_decompress((PGLZ_Header *) data, file->buf);
+	}
+
+	file->used = hdr.rawlen;
+	file->pos = 0;
+	file->ntuples = hdr.ntuples;
+	return true;
+}
+
+/*
+ * ExecHashBatchFileEnlarge
+ *		make a batch file's buffers big enough for a block of size bytes
+ */
+static void
+ExecHashBatchFileEnlarge(HashJoinBatchFile file, Size size)
+{
+	Assert(size > file->bufsize);
+	Assert(file->used == 0);
+
+	file->bufsize = size;
+	file->buf = repalloc(file->buf, file->bufsize);
+	if (file->lzbuf)
+		file->lzbuf = repalloc(file->lzbuf, PGLZ_MAX_OUTPUT(file->bufsize));
+}
+
+/*
+ * ExecHashSpillElapsed
+ *		seconds since *starttime
+ */
+static double
+ExecHashSpillElapsed(struct timeval *starttime)
+{
+	struct timeval endtime;
+
+	gettimeofday(&endtime, NULL);
+	return (double) (endtime.tv_sec - starttime->tv_sec) +
+		(double) (endtime.tv_usec - starttime->tv_usec) / 1000000.0;
+}
+
+/*
+ * Bloom filter support.
+ *
+ * A hash value picks its block with the low bits of a remixed copy of the
+ * value (bucketno uses the value modulo nbuckets, and batchno the low bits
+ * of another remix, so we don't want to reuse those bits), and one bit in
+ * each word of the block with the top five bits of the value times a
+ * per-word odd constant.
+ */
+static const uint32 hj_bloom_salt[HJ_BLOOM_BLOCK_WORDS] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+static uint32 *
+ExecHashBloomBlock(HashJoinTable hashtable, uint32 hashvalue)
+{
+	uint32		h = hashvalue;
+
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+
+	return hashtable->bloomFilter +
+		(h & (hashtable->nbloomBlocks - 1)) * HJ_BLOOM_BLOCK_WORDS;
+}
+
+static void
+ExecHashBloomAdd(HashJoinTable hashtable, uint32 hashvalue)
+{
+	uint32	   *block = ExecHashBloomBlock(hashtable, hashvalue);
+	int			i;
+
+	for (i = 0; i < HJ_BLOOM_BLOCK_WORDS; i++)
+		block[i] |= (uint32) 1 << ((hashvalue * hj_bloom_salt[i]) >> 27);
+}
+
+static bool
+ExecHashBloomCheck(HashJoinTable hashtable, uint32 hashvalue)
+{
+	uint32	   *block = ExecHashBloomBlock(hashtable, hashvalue);
+	int			i;
+
+	for (i = 0; i < HJ_BLOOM_BLOCK_WORDS; i++)
+	{
+		if ((block[i] & ((uint32) 1 << ((hashvalue * hj_bloom_salt[i]) >> 27))) == 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * ExecHashBloomTest
+ *		test whether the hash table might contain a tuple with the given
+ *		hash value; false means it certainly does not
+ *
+ * This is the probe-side entry point; it keeps the table's filter counters.
+ */
+bool
+ExecHashBloomTest(HashJoinTable hashtable, uint32 hashvalue)
+{
+	if (ExecHashBloomCheck(hashtable, hashvalue))
+	{
+		hashtable->bloomPassed += 1;
+		return true;
+	}
+	hashtable->bloomRejected += 1;
+	return false;
+}
+
+/*
+ * ExecHashCopyTuple
+ *		copy a tuple into a new HashJoinTuple in the batch context
+ *
+ * The caller links it into a bucket; its size is returned in *hashTupleSize.
+ */
+static HashJoinTuple
+ExecHashCopyTuple(HashJoinTable hashtable, HeapTuple tuple,
+				  uint32 hashvalue, int *hashTupleSize)
+{
+	HashJoinTuple hashTuple;
+
+	*hashTupleSize = MAXALIGN(sizeof(HashJoinTupleData)) + tuple->t_len;
+	hashTuple = (HashJoinTuple) ExecHashArenaAlloc(hashtable, *hashTupleSize);
+	hashTuple->hashvalue = hashvalue;
+	hashTuple->joined = false;
+	memcpy((char *) &hashTuple->htup,
+		   (char *) tuple,
+		   sizeof(hashTuple->htup));
+	hashTuple->htup.t_datamcxt = hashtable->batchCxt;
+	hashTuple->htup.t_data = (HeapTupleHeader)
+		(((char *) hashTuple) + MAXALIGN(sizeof(HashJoinTupleData)));
+	memcpy((char *) hashTuple->htup.t_data,
+		   (char *) tuple->t_data,
+		   tuple->t_len);
+
+	return hashTuple;
+}
+
+/*
+ * ExecHashArenaMapFile
+ *		map a new temp file of the given size
+ *
+ * The file's space is reserved before it is mapped: a sparse file would
+ * have its blocks allocated as the table first dirties its pages, and if
+ * the temp volume ran full then, the page fault would kill the backend
+ * with SIGBUS rather than raise an error.
+ *
+ * fd.c can't hand out the kernel descriptor of one of its virtual files,
+ * which mmap needs, so the file is opened with BasicOpenFile, but it goes
+ * where OpenTemporaryFile puts its files, under the same name prefix, so
+ * that RemovePgTempFiles finds it if a crash leaves it behind.  It is
+ * unlinked as soon as it is open; the mapping keeps it alive until it is
+ * unmapped.  Returns MAP_FAILED (after logging why) if it can't be had.
+ */
+static char *
+ExecHashArenaMapFile(Size size)
+{
+	static long fileCounter = 0;
+	char		path[MAXPGPATH];
+	char	   *base;
+	int			fd;
+
+	snprintf(path, sizeof(path), "%s/%s/%s%d.hj%ld",
+			 DatabasePath, HJ_TEMP_FILES_DIR, HJ_TEMP_FILE_PREFIX,
+			 MyProcPid, fileCounter++);
+	fd = BasicOpenFile(path, O_RDWR | O_CREAT | O_EXCL | PG_BINARY, 0600);
+	if (fd < 0)
+	{
+		/* no temp file has been made yet, so neither has the directory */
+		char		dirpath[MAXPGPATH];
+
+		snprintf(dirpath, sizeof(dirpath), "%s/%s",
+				 DatabasePath, HJ_TEMP_FILES_DIR);
+		mkdir(dirpath, S_IRWXU);
+		fd = BasicOpenFile(path, O_RDWR | O_CREAT | O_EXCL | PG_BINARY, 0600);
+	}
+	if (fd < 0)
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not create hash table file \"%s\": %m",
+						path)));
+		return MAP_FAILED;
+	}
+	unlink(path);
+
+	if (!ExecHashArenaReserve(fd, size))
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not reserve %lu bytes for hash table file: %m",
+						(unsigned long) size)));
+		close(fd);
+		return MAP_FAILED;
+	}
+
+	base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED)
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not map hash table file of %lu bytes: %m",
+						(unsigned long) size)));
+	close(fd);
+
+	return base;
+}
+
+/*
+ * ExecHashArenaReserve
+ *		allocate the blocks of a new, empty file of the given size
+ *
+ * posix_fallocate does it without writing, where the platform has it and
+ * the file system supports it; otherwise the file is filled with zeros.
+ * Returns false, with errno set, if there isn't the space.
+ */
+static bool
+ExecHashArenaReserve(int fd, Size size)
+{
+	char	   *zeros;
+	Size		done;
+
+#ifdef HAVE_POSIX_FALLOCATE
+	{
+		int			rc = posix_fallocate(fd, 0, size);
+
+		if (rc == 0)
+			return true;
+		if (rc != EINVAL && rc != EOPNOTSUPP)
+		{
+			errno = rc;
+			return false;
+		}
+		/* not supported by this file system; write the zeros ourselves */
+	}
+#endif
+
+	zeros = palloc0(HJ_RESERVE_CHUNK);
+	for (done = 0; done < size; done += HJ_RESERVE_CHUNK)
+	{
+		Size		len = Min(size - done, HJ_RESERVE_CHUNK);
+
+		errno = 0;
+		if (write(fd, zeros, len) != len)
+		{
+			/* if write didn't set errno, assume problem is no disk space */
+			if (errno == 0)
+				errno = ENOSPC;
+			pfree(zeros);
+			return false;
+		}
+	}
+	pfree(zeros);
+
+	return true;
+}
+
+/*
+ * ExecHashArenaMapAnon
+ *		map *size bytes of zeroed memory
+ *
+ * Under hashjoin_huge_pages, the mapping is aligned to and *size rounded up
+ * to HJ_HUGE_PAGE_SIZE, and *hugepages tells whether the kernel agreed to
+ * back it with huge pages.  If it didn't (no THP support, or THP turned off
+ * for madvise), the mapping still serves with normal pages.  Returns
+ * MAP_FAILED (after logging why) if there's no mapping at all.
+ */
+static char *
+ExecHashArenaMapAnon(Size *size, bool *hugepages)
+{
+	char	   *base;
+
+	*hugepages = false;
+
+#ifdef MADV_HUGEPAGE
+	if (hashjoin_huge_pages)
+	{
+		Size		hugesize = TYPEALIGN(HJ_HUGE_PAGE_SIZE, *size);
+		Size		mapsize = hugesize + HJ_HUGE_PAGE_SIZE;
+		char	   *raw;
+
+		/* map a huge page too much, and trim it to an aligned range */
+		raw = mmap(NULL, mapsize, PROT_READ | PROT_WRITE,
+				   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw != MAP_FAILED)
+		{
+			base = (char *) TYPEALIGN(HJ_HUGE_PAGE_SIZE, raw);
+			if (base > raw)
+				munmap(raw, base - raw);
+			if (base + hugesize < raw + mapsize)
+				munmap(base + hugesize, raw + mapsize - (base + hugesize));
+			*size = hugesize;
+			if (madvise(base, hugesize, MADV_HUGEPAGE) == 0)
+				*hugepages = true;
+			else
+				elog(DEBUG1, "huge pages not available for hash table: %m");
+			return base;
+		}
+	}
+#endif
+
+	base = mmap(NULL, *size, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED)
+		elog(LOG, "could not map %lu bytes for hash table: %m",
+			 (unsigned long) *size);
+
+	return base;
+}
+
+/*
+ * ExecHashArenaCreate
+ *		map a new temp file of the given size to keep a table's batch in,
+ *		or if anonymous, (at least) as much zeroed memory
+ *
+ * Returns NULL (after logging why) if the mapping can't be had, in which
+ * case the table does without.  A persistent table's arena has to be
+ * anonymous, and is left alone at transaction end.
+ */
+static HashJoinArenaData *
+ExecHashArenaCreate(Size size, bool anonymous, bool persistent)
+{
+	static bool registered = false;
+	HashJoinArenaData *arena;
+	char	   *base;
+	bool		hugepages = false;
+
+	if (anonymous)
+		base = ExecHashArenaMapAnon(&size, &hugepages);
+	else
+		base = ExecHashArenaMapFile(size);
+	if (base == MAP_FAILED)
+		return NULL;
+
+	/*
+	 * An error ends the query without ExecHashTableDestroy, so the arenas
+	 * are also tracked here, to be unmapped when the transaction ends.
+	 */
+	if (!registered)
+	{
+		RegisterXactCallback(ExecHashArenaAtXactEnd, NULL);
+		registered = true;
+	}
+	arena = (HashJoinArenaData *)
+		MemoryContextAlloc(TopMemoryContext, sizeof(HashJoinArenaData));
+	arena->base = base;
+	arena->size = size;
+	arena->used = 0;
+	arena->peak = 0;
+	arena->overflow = 0;
+	arena->hugePages = hugepages;
+	if (persistent)
+		arena->next = NULL;
+	else
+	{
+		arena->next = liveArenas;
+		liveArenas = arena;
+	}
+
+	return arena;
+}
+
+/*
+ * ExecHashArenaDestroy
+ *		unmap an arena and forget it
+ */
+static void
+ExecHashArenaDestroy(HashJoinArenaData *arena)
+{
+	HashJoinArenaData **prev;
+
+	for (prev = &liveArenas; *prev != NULL; prev = &(*prev)->next)
+	{
+		if (*prev == arena)
+		{
+			*prev = arena->next;
+			break;
+		}
+	}
+	if (munmap(arena->base, arena->size) < 0)
+		elog(LOG, "could not unmap hash table file: %m");
+	pfree(arena);
+}
+
+/*
+ * ExecHashArenaAtXactEnd
+ *		unmap the arenas of hash joins that never got to destroy them
+ *
+ * Tables with arenas are never persistent, so none of them can outlive
+ * the transaction.
+ */
+static void
+ExecHashArenaAtXactEnd(XactEvent event, void *arg)
+{
+	while (liveArenas != NULL)
+		ExecHashArenaDestroy(liveArenas);
+}
+
+/*
+ * ExecHashArenaAlloc
+ *		allocate batch storage for a table, from its arena if there's room
+ */
+static void *
+ExecHashArenaAlloc(HashJoinTable hashtable, Size size)
+{
+	HashJoinArenaData *arena = hashtable->arena;
+	char	   *pointer;
+
+	size = MAXALIGN(size);
+	if (arena == NULL)
+		return MemoryContextAlloc(hashtable->batchCxt, size);
+	if (arena->size - arena->used < size)
+	{
+		/*
+		 * Dumped tuples leave holes that are only reclaimed at the end of
+		 * the batch, so the arena can fill up before spaceAllowed does.
+		 */
+		if (arena->overflow == 0)
+			elog(DEBUG1, "hash table arena of %lu kB is full, allocating outside it",
+				 (unsigned long) (arena->size / 1024));
+		arena->overflow += size;
+		return MemoryContextAlloc(hashtable->batchCxt, size);
+	}
+
+	pointer = arena->base + arena->used;
+	arena->used += size;
+	if (arena->used > arena->peak)
+		arena->peak = arena->used;
+
+	return pointer;
+}
+
+/*
+ * ExecHashArenaFree
+ *		release storage from ExecHashArenaAlloc
+ *
+ * Arena storage only comes back when the batch ends (or, for a mapped
+ * bucket array, when ExecHashAllocBuckets replaces it), so this just
+ * pfree's anything that came from batchCxt instead.
+ */
+static void
+ExecHashArenaFree(HashJoinTable hashtable, void *pointer)
+{
+	if (HJ_IN_ARENA(hashtable->arena, pointer) ||
+		HJ_IN_ARENA(hashtable->bucketArena, pointer))
+		return;
+	pfree(pointer);
+}
+
+/*
+ * ExecHashMapArena
+ *		map the file of a table that has outgrown work_mem
+ *
+ * The mapping is mmapSize bytes, and the bucket array is charged against
+ * it: spaceAllowed becomes what is left for tuples.  The buckets and the
+ * tuples loaded so far stay where they are; the arena takes new tuples
+ * from now on, and the buckets too from the next batch on (see
+ * ExecHashAllocBuckets).  This is only tried once.  Returns true if the
+ * table has more room now.
+ */
+static bool
+ExecHashMapArena(HashJoinTable hashtable)
+{
+	Size		size = hashtable->mmapSize;
+	Size		bucketsize = hashtable->nbuckets * sizeof(HashJoinTuple);
+
+	hashtable->mmapSize = 0;
+	if (size <= bucketsize + hashtable->spaceAllowed)
+		return false;
+
+	/* if we can't get the file, we just batch now */
+	hashtable->arena = ExecHashArenaCreate(size, false, false);
+	if (hashtable->arena == NULL)
+		return false;
+
+	hashtable->spaceAllowed = size - bucketsize;
+	return true;
+}
+
+/*
+ * ExecHashAllocBuckets
+ *		allocate an empty bucket array for a table that holds no tuples,
+ *		replacing the old one
+ *
+ * If the table has an arena, it starts over: the array goes at its front,
+ * and only the part that earlier batches have touched needs zeroing.
+ * Otherwise a large array gets a fresh anonymous mapping, which costs
+ * nothing up front however many buckets there are; the kernel supplies
+ * zeroed pages as the first probes and insertions reach them.
+ */
+static HashJoinTuple *
+ExecHashAllocBuckets(HashJoinTable hashtable, long nbuckets)
+{
+	HashJoinArenaData *arena = hashtable->arena;
+	Size		size = nbuckets * sizeof(HashJoinTuple);
+	HashJoinTuple *buckets;
+
+	/* an old mapping would have to be zeroed; a new one is cheaper */
+	if (hashtable->bucketArena != NULL)
+	{
+		ExecHashArenaDestroy(hashtable->bucketArena);
+		hashtable->bucketArena = NULL;
+	}
+
+	if (arena != NULL)
+	{
+		Size		touched = arena->peak;
+
+		arena->used = 0;
+		buckets = (HashJoinTuple *) ExecHashArenaAlloc(hashtable, size);
+		if ((char *) buckets == arena->base)
+			MemSet(buckets, 0, Min(size, touched));
+		else
+			MemSet(buckets, 0, size);
+		return buckets;
+	}
+
+	if (size >= HJ_LAZY_BUCKETS_SIZE)
+	{
+		hashtable->bucketArena = ExecHashArenaCreate(size, true,
+													 hashtable->persistent);
+		if (hashtable->bucketArena != NULL)
+			return (HashJoinTuple *) hashtable->bucketArena->base;
+	}
+
+	/* past MaxAllocSize, only a mapping will do */
+	if (size > MaxAllocSize)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Could not map %lu bytes for %ld hash buckets.",
+						   (unsigned long) size, nbuckets)));
+
+	buckets = (HashJoinTuple *) MemoryContextAlloc(hashtable->batchCxt, size);
+	MemSet(buckets, 0, size);
+
+	return buckets;
+}
+
+/*
+ * ExecHashWindowAdd
+ *		link a new tuple into a windowed hash table, evicting the oldest
+ *		tuple if the window is full
+ *
+ * The new tuple is appended to its bucket, so every bucket stays in
+ * insertion order and the oldest tuple in the table is always the head of
+ * its own bucket; eviction is thus O(1).  The evicted tuple's memory goes
+ * back to batchCxt's free lists, where the next insertions of similar size
+ * pick it up again, so a full window runs in constant memory.
+ */
+static void
+ExecHashWindowAdd(HashJoinTable hashtable, HashJoinTuple hashTuple,
+				  long bucketno)
+{
+	HashJoinTuple oldest = hashtable->windowRing[hashtable->windowNext];
+
+	if (oldest != NULL)
+	{
+		long		oldbucketno;
+		int			oldbatchno;
+
+		ExecHashGetBucketAndBatch(hashtable, oldest->hashvalue,
+								  &oldbucketno, &oldbatchno);
+		Assert(hashtable->buckets[oldbucketno] == oldest);
+		hashtable->buckets[oldbucketno] = oldest->next;
+		if (hashtable->bucketTails[oldbucketno] == oldest)
+			hashtable->bucketTails[oldbucketno] = NULL;
+		hashtable->spaceUsed -=
+			MAXALIGN(sizeof(HashJoinTupleData)) + oldest->htup.t_len;
+		hashtable->windowEvicted += 1;
+		pfree(oldest);
+	}
+
+	hashTuple->next = NULL;
+	if (hashtable->bucketTails[bucketno] != NULL)
+		hashtable->bucketTails[bucketno]->next = hashTuple;
+	else
+		hashtable->buckets[bucketno] = hashTuple;
+	hashtable->bucketTails[bucketno] = hashTuple;
+
+	hashtable->windowRing[hashtable->windowNext] = hashTuple;
+	hashtable->windowNext = (hashtable->windowNext + 1) % hashtable->windowSize;
+
+	/*
+	 * Evicted tuples leave their Bloom filter bits behind, so on an endless
+	 * input the filter would eventually pass everything.  Each time the
+	 * window has turned over completely, rebuild it from the ring; that
+	 * costs one pass over the window per windowSize insertions.
+	 */
+	if (hashtable->windowNext == 0)
+	{
+		int			i;
+
+		MemSet(hashtable->bloomFilter, 0,
+			   hashtable->nbloomBlocks * HJ_BLOOM_BLOCK_WORDS * sizeof(uint32));
+		for (i = 0; i < hashtable->windowSize; i++)
+		{
+			if (hashtable->windowRing[i] != NULL &&
+				hashtable->windowRing[i] != hashTuple)
+				ExecHashBloomAdd(hashtable, hashtable->windowRing[i]->hashvalue);
+		}
+	}
+}
+
+/*
+ * ExecHashTablePurge
+ *		remove the tuples whose join key can no longer find a match
+ *
+ * The other input has promised never again to return a key below bound,
+ * so every tuple here whose key compares below it is dead weight.  cmpfn
+ * compares the two inputs' key types ("<" or ">", as the caller needs): a
+ * tuple goes if cmpfn(bound, key) is true when boundIsLeft, or if
+ * cmpfn(key, bound) is true otherwise.  Tuples with a null key can never
+ * match and go too.  Keys are recomputed from the stored tuples with
+ * hashstate's hash key, which late materialization always keeps.
+ *
+ * Returns the number of tuples removed.  Not for windowed tables, whose
+ * ring still points at the tuples.
+ */
+double
+ExecHashTablePurge(HashJoinTable hashtable, HashState *hashstate,
+				   FmgrInfo *cmpfn, Datum bound, bool boundIsLeft)
+{
+	ExprContext *econtext = hashstate->ps.ps_ExprContext;
+	TupleTableSlot *slot = hashstate->ps.ps_ResultTupleSlot;
+	ExprState  *keyexpr;
+	double		npurged = 0;
+	long		i;
+
+	Assert(hashtable->windowSize == 0);
+	Assert(list_length(hashstate->hashkeys) == 1);
+	keyexpr = (ExprState *) linitial(hashstate->hashkeys);
+
+	/* walk the main buckets, then the skew buckets */
+	for (i = 0; i < hashtable->nbuckets + hashtable->skewBucketLen; i++)
+	{
+		HashJoinTuple *prev;
+		bool		isskew = (i >= hashtable->nbuckets);
+
+		if (!isskew)
+			prev = &hashtable->buckets[i];
+		else if (hashtable->skewBucket[i - hashtable->nbuckets] != NULL)
+			prev = &hashtable->skewBucket[i - hashtable->nbuckets]->tuples;
+		else
+			continue;
+
+		while (*prev != NULL)
+		{
+			HashJoinTuple hashTuple = *prev;
+			MemoryContext oldContext;
+			Datum		key;
+			bool		isNull;
+			bool		dead;
+			Size		tupleSize;
+
+			ResetExprContext(econtext);
+			ExecStoreTuple(&hashTuple->htup, slot, InvalidBuffer, false);
+			econtext->ecxt_innertuple = slot;
+			econtext->ecxt_outertuple = slot;
+
+			oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+			key = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
+			if (isNull)
+				dead = true;
+			else if (boundIsLeft)
+				dead = DatumGetBool(FunctionCall2(cmpfn, bound, key));
+			else
+				dead = DatumGetBool(FunctionCall2(cmpfn, key, bound));
+			MemoryContextSwitchTo(oldContext);
+
+			if (!dead)
+			{
+				prev = &hashTuple->next;
+				continue;
+			}
+
+			*prev = hashTuple->next;
+			tupleSize = MAXALIGN(sizeof(HashJoinTupleData)) +
+				hashTuple->htup.t_len;
+			if (isskew)
+				hashtable->spaceUsedSkew -= tupleSize;
+			else if (hashtable->batchSpace != NULL)
+			{
+				long		bucketno;
+				int			batchno;
+
+				ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
+										  &bucketno, &batchno);
+				hashtable->batchSpace[batchno] -= tupleSize;
+			}
+			hashtable->spaceUsed -= tupleSize;
+			ExecClearTuple(slot);
+			ExecHashArenaFree(hashtable, hashTuple);
+			npurged += 1;
+		}
+	}
+
+	ExecClearTuple(slot);
+	hashtable->purgedTuples += npurged;
+
+	return npurged;
+}
+
+/*
+ * ExecHashGetHashValue
+ *		Compute the hash value for a tuple
+ *
+ * The tuple to be tested must be in either econtext->ecxt_outertuple or
+ * econtext->ecxt_innertuple.  Vars in the hashkeys expressions reference
+ * either OUTER or INNER.
+ */
+uint32
+ExecHashGetHashValue(HashJoinTable hashtable,
+					 ExprContext *econtext,
+					 List *hashkeys)
+{
+	uint32		hashkey = 0;
+	ListCell   *hk;
+	int			i = 0;
+	MemoryContext oldContext;
+
+	/*
+	 * We reset the eval context each time to reclaim any memory leaked in the
+	 * hashkey expressions.
+	 */
+	ResetExprContext(econtext);
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	foreach(hk, hashkeys)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(hk);
+		Datum		keyval;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		/*
+		 * Get the join attribute value of the tuple
+		 */
+		keyval = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
+
+		/*
+		 * Compute the hash function
+		 */
+		if (!isNull)			/* treat nulls as having hash key 0 */
+		{
+			uint32		hkey;
+
+			hkey = DatumGetUInt32(FunctionCall1(&hashtable->hashfunctions[i],
+												keyval));
+			hashkey ^= hkey;
+		}
+
+		i++;
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return hashkey;
+}
+
+/*
+ * ExecHashGetBucketAndBatch
+ *		Determine the bucket number and batch number for a hash value
+ *
+ * Note: on-the-fly increases of nbatch must not change the bucket number
+ * for a given hash code (since we don't move tuples to different hash
+ * chains), and must only cause the batch number to remain the same or
+ * increase.  Our algorithm is
+ *		bucketno = hashvalue MOD nbuckets
+ *		batchno = remix(hashvalue) MOD nbatch
+ * where nbuckets should preferably be prime so that all bits of the
+ * hash value can affect bucketno, and remix is a bijective integer mix
+ * that lets all bits of the hash value affect batchno, too.
+ * nbuckets doesn't change over the course of the join.  (Taking batchno
+ * from hashvalue DIV nbuckets instead would leave a single bit for it once
+ * nbuckets reaches 2^31.)  The remix's constants differ from those of
+ * ExecHashBloomBlock, so that the tuples of one batch still spread over
+ * the whole Bloom filter.
+ *
+ * nbatch is always a power of 2; we increase it only by doubling it.  This
+ * effectively adds one more bit to the top of the batchno.
+ */
+void
+ExecHashGetBucketAndBatch(HashJoinTable hashtable,
+						  uint32 hashvalue,
+						  long *bucketno,
+						  int *batchno)
+{
+	uint32		nbuckets = (uint32) hashtable->nbuckets;
+	uint32		nbatch = (uint32) hashtable->nbatch;
+
+	if (nbatch > 1)
+	{
+		uint32		h = hashvalue;
+
+		*bucketno = hashvalue % nbuckets;
+		h ^= h >> 16;
+		h *= 0x7feb352dU;
+		h ^= h >> 15;
+		h *= 0x846ca68bU;
+		h ^= h >> 16;
+		/* since nbatch is a power of 2, can do MOD by masking */
+		*batchno = h & (nbatch - 1);
+	}
+	else
+	{
+		*bucketno = hashvalue % nbuckets;
+		*batchno = 0;
+	}
+}
+
+/*
+ * ExecScanHashBucket
+ *		scan a hash bucket for matches to the current probing tuple
+ *
+ * CSI3130: if hj_InFetched, the current inner tuple (in
+ * econtext->ecxt_innertuple) probes the outer hash table; otherwise the
+ * current outer tuple (in econtext->ecxt_outertuple) probes the inner one.
+ * The matching hashtable tuple is put in the opposite econtext slot, so the
+ * hashclauses always see outer and inner tuples the right way round.
+ */
+HeapTuple
+ExecScanHashBucket(HashJoinState *hjstate,
+				   ExprContext *econtext) {
+    List *hjclauses = hjstate->hashclauses;
+    HashJoinTable hashtable;
+    HashJoinTuple hashTuple;
+    TupleTableSlot *hashSlot;
+    uint32 hashvalue;
+    int skewbucket;
+
+    if (hjstate->hj_InFetched) { //CSI3130
+        hashtable = hjstate->hj_OutHashTable;
+        hashTuple = hjstate->hj_OutCurTuple;
+        hashvalue = hjstate->hj_InCurHashValue;
+        hashSlot = hjstate->hj_OutHashTupleSlot;
+        skewbucket = hjstate->hj_OutCurSkewBucketNo;
+
+        /*
+         * hj_OutCurTuple is NULL to start scanning a new bucket, or the
+         * address of the last tuple returned from the current bucket.
+         * If the Bloom filter already ruled the probe out, there is no
+         * bucket to look at.
+         */
+        if (hashTuple == NULL)
+        {
+            if (hjstate->hj_OutCurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
+                hashTuple = hashtable->skewBucket[hjstate->hj_OutCurSkewBucketNo]->tuples;
+            else if (hjstate->hj_OutCurBucketNo == HJ_NO_BUCKET)
+                return NULL;
+            else
+                hashTuple = hashtable->buckets[hjstate->hj_OutCurBucketNo];
+        }
+        else
+            hashTuple = hashTuple->next;
+    } else {
+        hashtable = hjstate->hj_InHashTable; //CSI3130
+        hashTuple = hjstate->hj_InCurTuple; //CSI3130
+        hashvalue = hjstate->hj_OutCurHashValue;
+        hashSlot = hjstate->hj_InHashTupleSlot;
+        skewbucket = hjstate->hj_InCurSkewBucketNo;
+
+        if (hashTuple == NULL)
+        {
+            if (hjstate->hj_InCurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
+                hashTuple = hashtable->skewBucket[hjstate->hj_InCurSkewBucketNo]->tuples;
+            else if (hjstate->hj_InCurBucketNo == HJ_NO_BUCKET)
+                return NULL;
+            else
+                hashTuple = hashtable->buckets[hjstate->hj_InCurBucketNo];
+        }
+        else
+            hashTuple = hashTuple->next;
+    }
+
+    while (hashTuple != NULL) {
+        /* both joined in the first pass; see ExecHashIncreaseNumBatches */
+        if (hashTuple->hashvalue == hashvalue &&
+            !(hjstate->hj_ProbeJoined && hashTuple->joined)) {
+            HeapTuple heapTuple = &hashTuple->htup;
+            TupleTableSlot *hashtuple;
+
+            /* insert hashtable's tuple into exec slot so ExecQual sees it */
+            hashtuple = ExecStoreTuple(heapTuple,
+                                       hashSlot,
+                                       InvalidBuffer,
+                                       false);    /* do not pfree */
+            if (hjstate->hj_InFetched)
+                econtext->ecxt_outertuple = hashtuple;
+            else
+                econtext->ecxt_innertuple = hashtuple;
+
+            /* reset temp memory each time to avoid leaks from qual expr */
+            ResetExprContext(econtext);
+
+            if (ExecQual(hjclauses, econtext, false)) {
+                /* count first-pass matches for ExecHashFlushBatches */
+                if (hashtable->batchHits != NULL &&
+                    hashtable->curbatch == 0 &&
+                    skewbucket == INVALID_SKEW_BUCKET_NO) {
+                    long bucketno;
+                    int batchno;
+
+                    ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
+                                              &bucketno, &batchno);
+                    hashtable->batchHits[batchno] += 1;
+                }
+                if (hjstate->hj_InFetched)
+                    hjstate->hj_OutCurTuple = hashTuple;
+                else
+                    hjstate->hj_InCurTuple = hashTuple;
+                return heapTuple;
+            }
+        }
+
+        hashTuple = hashTuple->next;
+    }
+
+    /*
+     * no match
+     */
+    return NULL;
+}
+
+/*
+ * ExecHashTableReset
+ *
+ *		reset hash table header for new batch
+ */
+void
+ExecHashTableReset(HashJoinTable hashtable) {
+        MemoryContext oldcxt;
+        long nbuckets = hashtable->nbuckets;
+
+        /*
+         * Release all the hash buckets and tuples acquired in the prior pass, and
+         * reinitialize the context for a new pass.
+         */
+        MemoryContextReset(hashtable->batchCxt);
+        oldcxt = MemoryContextSwitchTo(hashtable->batchCxt);
+
+        /* Reallocate and reinitialize the hash bucket headers. */
+        hashtable->buckets = ExecHashAllocBuckets(hashtable, nbuckets);
+        if (hashtable->windowSize > 0)
+        {
+            hashtable->bucketTails = (HashJoinTuple *)
+                    palloc0(nbuckets * sizeof(HashJoinTuple));
+            MemSet(hashtable->windowRing, 0,
+                   hashtable->windowSize * sizeof(HashJoinTuple));
+            hashtable->windowNext = 0;
+        }
+
+        hashtable->spaceUsed = 0;
+        if (hashtable->batchSpace != NULL)
+            MemSet(hashtable->batchSpace, 0,
+                   hashtable->nbatch * sizeof(Size));
+        hashtable->newestTuple = NULL;
+
+        /*
+         * The skew buckets only serve the first pass, and went away with
+         * the rest of batchCxt; hot-key tuples were never dumped to a batch
+         * file, so later batches have no use for them.
+         */
+        hashtable->skewEnabled = false;
+        hashtable->skewBucket = NULL;
+        hashtable->skewBucketLen = 0;
+        hashtable->nSkewBuckets = 0;
+        hashtable->skewBucketNums = NULL;
+        hashtable->spaceUsedSkew = 0;
+
+        /* The new batch's tuples will set their own filter bits */
+        MemSet(hashtable->bloomFilter, 0,
+               hashtable->nbloomBlocks * HJ_BLOOM_BLOCK_WORDS * sizeof(uint32));
+
+        MemoryContextSwitchTo(oldcxt);
+}
+
+void
+ExecReScanHash(HashState *node, ExprContext *exprCtxt) {
+        /* the other input will be read again, so it no longer filters ours */
+        node->filtertable = NULL;
+
+        /*
+         * if chgParam of subnode is not null then plan will be re-scanned by
+         * first ExecProcNode.
+         */
+        if (((PlanState *) node)->lefttree->chgParam == NULL)
+            ExecReScan(((PlanState *) node)->lefttree, exprCtxt);
+}
+
+/*
+ * assign_hashjoin_batch_order
+ *		GUC assign hook for hashjoin_batch_order, which is set by name
+ */
+const char *
+assign_hashjoin_batch_order(const char *newval, bool doit, GucSource source)
+{
+	int			order;
+
+	if (pg_strcasecmp(newval, "largest") == 0)
+		order = HJ_BATCH_ORDER_LARGEST;
+	else if (pg_strcasecmp(newval, "smallest") == 0)
+		order = HJ_BATCH_ORDER_SMALLEST;
+	else if (pg_strcasecmp(newval, "matches") == 0)
+		order = HJ_BATCH_ORDER_MATCHES;
+	else
+		return NULL;			/* fail */
+
+	if (doit)
+		hashjoin_batch_order = order;
+
+	return newval;				/* OK */
+}
+
+/*
+ * assign_hashjoin_flush_policy
+ *		GUC assign hook for hashjoin_flush_policy, which is set by name
+ */
+const char *
+assign_hashjoin_flush_policy(const char *newval, bool doit, GucSource source)
+{
+	int			policy;
+
+	if (pg_strcasecmp(newval, "largest") == 0)
+		policy = HJ_FLUSH_LARGEST;
+	else if (pg_strcasecmp(newval, "adaptive") == 0)
+		policy = HJ_FLUSH_ADAPTIVE;
+	else
+		return NULL;			/* fail */
+
+	if (doit)
+		hashjoin_flush_policy = policy;
+
+	return newval;				/* OK */
+}
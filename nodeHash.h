@@ -0,0 +1,119 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeHash.h
+ *	  prototypes for nodeHash.c
+ *
+ *
+ * Portions Copyright (c) 1996-2005, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * $PostgreSQL: pgsql/src/include/executor/nodeHash.h,v 1.38 2005/10/15 02:49:44 momjian Exp $
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef NODEHASH_H
+#define NODEHASH_H
+
+#include "executor/hashjoin.h"
+#include "nodes/execnodes.h"
+#include "utils/guc.h"
+
+/* GUC parameters */
+extern int	hashjoin_window_size;
+
+/* the largest window whose ring a single palloc can hold */
+#define HJ_MAX_WINDOW_SIZE \
+	((int) (MaxAllocSize / sizeof(HashJoinTuple)))
+
+extern char *hashjoin_state_name;
+extern char *hashjoin_checkpoint_file;
+extern int	hashjoin_checkpoint_interval;
+extern bool hashjoin_spill_compression;
+extern char *hashjoin_batch_order_string;
+extern int	hashjoin_batch_order;
+
+/* values of hashjoin_batch_order */
+#define HJ_BATCH_ORDER_LARGEST		0
+#define HJ_BATCH_ORDER_SMALLEST		1
+#define HJ_BATCH_ORDER_MATCHES		2
+
+extern char *hashjoin_flush_policy_string;
+extern int	hashjoin_flush_policy;
+
+/* values of hashjoin_flush_policy */
+#define HJ_FLUSH_LARGEST			0
+#define HJ_FLUSH_ADAPTIVE			1
+
+extern int	hashjoin_mmap_mem;
+extern bool hashjoin_huge_pages;
+
+extern const char *assign_hashjoin_batch_order(const char *newval,
+							bool doit, GucSource source);
+extern const char *assign_hashjoin_flush_policy(const char *newval,
+							 bool doit, GucSource source);
+
+extern int	ExecCountSlotsHash(Hash *node);
+extern HashState *ExecInitHash(Hash *node, EState *estate);
+extern TupleTableSlot *ExecHash(HashState *node);
+extern Node *MultiExecHash(HashState *node);
+extern void ExecEndHash(HashState *node);
+extern void ExecReScanHash(HashState *node, ExprContext *exprCtxt);
+
+extern HashJoinTable ExecHashTableCreate(Hash *node, List *hashOperators,
+					bool persistent, bool checkpointed);
+extern void ExecHashTableDestroy(HashJoinTable hashtable);
+extern void ExecHashTableInsert(HashJoinTable hashtable,
+					HeapTuple tuple,
+					uint32 hashvalue);
+extern void ExecHashTableReload(HashJoinTable hashtable,
+					HeapTuple tuple,
+					uint32 hashvalue,
+					bool joined);
+extern void ExecHashTableSaveTuple(HashJoinTable hashtable,
+					   HeapTuple tuple,
+					   uint32 hashvalue,
+					   int batchno,
+					   bool joined);
+extern void ExecHashTableLink(HashJoinTable outtable, HashJoinTable intable);
+extern void ExecHashTableEndFirstPass(HashJoinTable hashtable);
+extern void ExecHashBatchFileWrite(HashJoinBatchFile *fileptr,
+					   HashJoinSpillStats *stats,
+					   HeapTuple tuple,
+					   uint32 hashvalue);
+extern HeapTuple ExecHashBatchFileRead(HashJoinBatchFile file,
+					  uint32 *hashvalue);
+extern void ExecHashBatchFileRewind(HashJoinBatchFile file);
+extern void ExecHashBatchFileClose(HashJoinBatchFile file);
+extern uint32 ExecHashGetHashValue(HashJoinTable hashtable,
+					 ExprContext *econtext,
+					 List *hashkeys);
+extern void ExecHashGetBucketAndBatch(HashJoinTable hashtable,
+						  uint32 hashvalue,
+						  long *bucketno,
+						  int *batchno);
+extern HeapTuple ExecScanHashBucket(HashJoinState *hjstate,
+				   ExprContext *econtext);
+extern bool ExecHashBloomTest(HashJoinTable hashtable, uint32 hashvalue);
+extern void ExecHashTableReset(HashJoinTable hashtable);
+extern void ExecChooseHashTableSize(double ntuples, int tupwidth,
+						int *numbuckets,
+						int *numbatches);
+extern bool ExecChooseHashLateMaterialization(double ntuples, int tupwidth,
+								  double nmatches);
+extern void ExecHashLateMaterialize(HashJoinTable hashtable,
+						HashState *hashstate,
+						double nmatches);
+extern void ExecHashBuildSkewHash(HashJoinTable outtable, HashState *outnode,
+					  HashJoinTable intable, HashState *innode);
+extern int	ExecHashGetSkewBucket(HashJoinTable hashtable, uint32 hashvalue);
+extern double ExecHashTablePurge(HashJoinTable hashtable,
+				   HashState *hashstate,
+				   FmgrInfo *cmpfn,
+				   Datum bound,
+				   bool boundIsLeft);
+extern TupleTableSlot *ExecHashStoreMatch(HashJoinTable hashtable,
+				   HeapTuple tuple,
+				   TupleTableSlot *slot,
+				   EState *estate);
+
+#endif   /* NODEHASH_H */
@@ -1,828 +1,2563 @@
-/*-------------------------------------------------------------------------
- *
- * nodeHashjoin.c
- *	  Routines to handle hash join nodes
- *
- * Portions Copyright (c) 1996-2005, PostgreSQL Global Development Group
- * Portions Copyright (c) 1994, Regents of the University of California
- *
- *
- * IDENTIFICATION
- *	  $PostgreSQL: pgsql/src/backend/executor/nodeHashjoin.c,v 1.75.2.4 2007/02/02 00:07:44 tgl Exp $
- *
- *-------------------------------------------------------------------------
- */
-
-#include "postgres.h"
-
-#include "executor/executor.h"
-#include "executor/hashjoin.h"
-#include "executor/nodeHash.h"
-#include "executor/nodeHashjoin.h"
-#include "optimizer/clauses.h"
-#include "utils/memutils.h"
-#include "nodes/execnodes.h"
-#include "../../include/nodes/execnodes.h"
-#include "../../include/executor/hashjoin.h"
-
-
-static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
-                                                 HashJoinState *hjstate,
-                                                 uint32 *hashvalue);
-static TupleTableSlot *ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
-                                                 BufFile *file,
-                                                 uint32 *hashvalue,
-                                                 TupleTableSlot *tupleSlot);
-static int	ExecHashJoinNewBatch(HashJoinState *hjstate);
-
-
-/* ----------------------------------------------------------------
- *		ExecHashJoin
- *
- *		This function implements the Hybrid Hashjoin algorithm.
- *
- *		Note: the relation we build hash table on is the "inner"
- *			  the other one is "outer".
- * ----------------------------------------------------------------
- */
-TupleTableSlot *				/* return: a tuple or NULL */
-ExecHashJoin(HashJoinState *node)
-{
-    EState	   *estate;
-    HashState  *outHashNode; //CSI3130
-    HashState  *inHashNode; //cSI3130
-    List	   *joinqual;
-    List	   *otherqual;
-    TupleTableSlot *inntuple;
-    TupleTableSlot *outtuple; //CSI3130
-    ExprContext *econtext;
-    ExprDoneCond isDone;
-    HashJoinTable inhashtable; //CSI3130
-    HashJoinTable outhashtable; //CSI3130
-    HeapTuple	curtuple;
-    TupleTableSlot *outerTupleSlot;
-    TupleTableSlot *innerTupleSlot; //CSI3130
-    uint32		hashvalue;
-    int			batchno;
-
-    /*
-     * get information from HashJoin node
-     */
-    estate = node->js.ps.state;
-    joinqual = node->js.joinqual;
-    otherqual = node->js.ps.qual;
-    inHashNode = (HashState *) innerPlanState(node);
-    outHashNode = (HashState *) outerPlanState(node); //CSI3130
-
-
-    /*
-     * get information from HashJoin state
-     */
-    inhashtable = node->hj_InHashTable; //CSI3130
-    outhashtable = node->hj_OutHashTable; //CSI3130
-    econtext = node->js.ps.ps_ExprContext;
-
-    /*
-     * Check to see if we're still projecting out tuples from a previous join
-     * tuple (because there is a function-returning-set in the projection
-     * expressions).  If so, try to project another one.
-     */
-    /*CSI3130
-     *  Do w need this?*/
-//    if (node->js.ps.ps_TupFromTlist)
-//    {
-//        TupleTableSlot *result;
-//
-//        result = ExecProject(node->js.ps.ps_ProjInfo, &isDone);
-//        if (isDone == ExprMultipleResult)
-//            return result;
-//        /* Done with that source tuple... */
-//        node->js.ps.ps_TupFromTlist = false;
-//    }
-
-    /*
-     * If we're doing an IN join, we want to return at most one row per outer
-     * tuple; so we can stop scanning the inner scan if we matched on the
-     * previous try.
-     */
-    if (node->js.jointype == JOIN_IN && node->hj_MatchedOuter)
-        node->hj_NeedNewOuter = true;
-
-    /*
-     * Reset per-tuple memory context to free any expression evaluation
-     * storage allocated in the previous tuple cycle.  Note this can't happen
-     * until we're done projecting out tuples from a join tuple.
-     */
-    ResetExprContext(econtext);
-
-    /*
-     * if this is the first call, build the hash table for inner relation
-     */
-    if (inhashtable == NULL && outhashtable == NULL) //CSI3130
-    {
-        /*
-         * If the outer relation is completely empty, we can quit without
-         * building the hash table.  However, for an inner join it is only a
-         * win to check this when the outer relation's startup cost is less
-         * than the projected cost of building the hash table.	Otherwise it's
-         * best to build the hash table first and see if the inner relation is
-         * empty.  (When it's an outer join, we should always make this check,
-         * since we aren't going to be able to skip the join on the strength
-         * of an empty inner relation anyway.)
-         *
-         * If we are rescanning the join, we make use of information gained
-         * on the previous scan: don't bother to try the prefetch if the
-         * previous scan found the outer relation nonempty.  This is not
-         * 100% reliable since with new parameters the outer relation might
-         * yield different results, but it's a good heuristic.
-         *
-         * The only way to make the check is to try to fetch a tuple from the
-         * outer plan node.  If we succeed, we have to stash it away for later
-         * consumption by ExecHashJoinOuterGetTuple.
-         */
-        //CSI3130 - Not needed?
-//        if (node->js.jointype == JOIN_LEFT ||
-//            (outerNode->plan->startup_cost < hashNode->ps.plan->total_cost &&
-//             !node->hj_OuterNotEmpty))
-//        {
-//            node->hj_FirstOuterTupleSlot = ExecProcNode(outerNode);
-//            if (TupIsNull(node->hj_FirstOuterTupleSlot))
-//            {
-//                node->hj_OuterNotEmpty = false;
-//                return NULL;
-//            }
-//            else
-//                node->hj_OuterNotEmpty = true;
-//        }
-//        else
-//            node->hj_FirstOuterTupleSlot = NULL;
-
-        /*
-         * create the hash table
-         */
-        inhashtable = ExecHashTableCreate((Hash *) inHashNode->ps.plan,
-                                          node->hj_HashOperators); //CSI3130
-        outhashtable = ExecHashTableCreate((Hash *) outHashNode->ps.plan,
-                                           node->hj_HashOperators); //cSI3130
-        node->hj_InHashTable = inhashtable;
-
-        /*
-         * execute the Hash node, to build the hash table
-         */
-        inHashNode->hashtable = inhashtable; //CSI3130
-        outHashNode->hashtable = outhashtable; //CSI3130
-
-        //(void) MultiExecProcNode((PlanState *) hashNode); //CSI3130 - not needed?
-
-        /*
-         * If the inner relation is completely empty, and we're not doing an
-         * outer join, we can quit without scanning the outer relation.
-         */
-        //CSI3130 - not needed?
-//        if (hashtable->totalTuples == 0 && node->js.jointype != JOIN_LEFT)
-//            return NULL;
-
-        /*
-         * need to remember whether nbatch has increased since we began
-         * scanning the outer relation
-         */ //CSI3130 - not needed?
-        //hashtable->nbatch_outstart = hashtable->nbatch;
-
-        /*
-         * Reset OuterNotEmpty for scan.  (It's OK if we fetched a tuple
-         * above, because ExecHashJoinOuterGetTuple will immediately
-         * set it again.)
-         */
-        //node->hj_OuterNotEmpty = false; //CSI3130 not needed?
-    }
-    /*
-     * run the hash join process
-     * CSI3130
-     */
-    for (;;)
-    {
-        if(!node->hj_inExauhsted || !node->hj_outExauhsted){
-            if(node->hj_inExauhsted)
-                node->hj_InFetched = false;
-            if(node->hj_outExauhsted)
-                node->hj_InFetched = true;
-
-            if (!node->hj_inExauhsted && node->hj_NeedNewIn && node->hj_InFetched) {
-                innerTupleSlot = ExecProcNode((PlanState *) inHashNode);
-                node->js.ps.ps_InnerTupleSlot = innerTupleSlot;
-
-                if (!TupIsNull(innerTupleSlot)) {
-
-                    node->hj_NeedNewIn = false;
-
-                    // Set the econtext, a lot of functions can only see the tuple if put into econtext
-                    econtext = node->js.ps.ps_ExprContext;
-                    econtext->ecxt_innertuple = innerTupleSlot;
-
-                    // Get hash values of inner tuple
-                    hashvalue = ExecHashGetHashValue(outhashtable, econtext, node->hj_InnerHashKeys);
-
-
-                    // Reset the current inner tuple
-                    node->js.ps.ps_InnerTupleSlot = innerTupleSlot;
-                    // Set the econtext
-                    econtext->ecxt_innertuple = node->js.ps.ps_InnerTupleSlot;
-
-                    // Find corresponding bucket
-                    node->hj_InCurHashValue = hashvalue;
-                    ExecHashGetBucketAndBatch(outhashtable, hashvalue, &node->hj_OutCurBucketNo, &batchno); // &batchno -> 0 or 1
-                    node->hj_OutCurTuple = NULL;
-
-                } else {
-
-                    node->hj_inExauhsted = true;
-                }
-            }
-
-            if (!node->hj_outExauhsted && node->hj_NeedNewOuter  && !node->hj_InFetched) {
-                outerTupleSlot = ExecProcNode((PlanState *) outHashNode);
-                node->js.ps.ps_OuterTupleSlot = outerTupleSlot;
-
-                if (!TupIsNull(outerTupleSlot)) {
-
-                    node->hj_NeedNewOuter = false;
-
-                    // Set the econtext, a lot of functions can only see the tuple if put into econtext
-                    econtext = node->js.ps.ps_ExprContext;
-                    econtext->ecxt_outertuple = outerTupleSlot;
-
-                    // Get hash values of inner tuple
-                    hashvalue = ExecHashGetHashValue(inhashtable, econtext, node->hj_OuterHashKeys);
-
-                    // Reset the current outer tuple
-                    node->js.ps.ps_OuterTupleSlot = outerTupleSlot;
-                    econtext->ecxt_outertuple = node->js.ps.ps_OuterTupleSlot;
-
-                    // Find corresponding bucket
-                    node->hj_OutCurHashValue = hashvalue;
-                    ExecHashGetBucketAndBatch(inhashtable, hashvalue, &node->hj_InCurBucketNo,
-                                              &batchno); // &batchno -> 0 or 1
-                    node->hj_InCurTuple = NULL;
-
-                } else {
-
-                    node->hj_outExauhsted = true;
-                }
-            }
-
-            if (node->hj_inExauhsted && node->hj_outExauhsted)
-                return NULL;
-
-            if (!TupIsNull(node->js.ps.ps_InnerTupleSlot) && node->hj_InFetched) {
-
-                for (;;) {
-                    ExprContext *econtext = node->js.ps.ps_ExprContext;
-                    econtext->ecxt_innertuple = node->js.ps.ps_InnerTupleSlot;
-                    curtuple = ExecScanHashBucket(node, econtext);
-                    if (curtuple == NULL) {
-                        node->hj_InFetched = false;
-                        break;
-                    }
-
-
-                    /*
-                     * we've got a match, but still need to test non-hashed quals
-                    */
-                    outtuple = ExecStoreTuple(curtuple, node->hj_OuterTupleSlot, InvalidBuffer, false);	/* don't free this tuple */
-                    econtext->ecxt_outertuple = outtuple;
-
-                    /* reset temp memory each time to avoid leaks from qual expr */
-                    ResetExprContext(econtext);
-
-                    /*
-                    * if we pass the qual, then save state for next call and have
-                    * ExecProject form the projection, store it in the tuple table,
-                    * and return the slot.
-                    *
-                    * Only the joinquals determine MatchedOuter status, but all quals
-                    * must pass to actually return the tuple.
-                    */
-                    if (joinqual == NIL || ExecQual(joinqual, econtext, false)) {
-                        if (otherqual == NIL || ExecQual(otherqual, econtext, false)) {
-                            TupleTableSlot *result;
-                            result = ExecProject(node->js.ps.ps_ProjInfo, &isDone);
-                            if (isDone != ExprEndResult) {
-                                node->hj_OutProbing=node->hj_OutProbing+1;
-                                node->js.ps.ps_TupFromTlist = (isDone == ExprMultipleResult);
-                                return result;
-                            }
-                        }
-                    }
-                }
-                node->hj_NeedNewIn = true;
-                node->js.ps.ps_InnerTupleSlot = NULL;
-                node->hj_InFetched = false;
-                continue;
-            }
-
-            if(!TupIsNull(node->js.ps.ps_OuterTupleSlot) && !node->hj_InFetched){
-                for(;;) {
-                    ExprContext *econtext = node->js.ps.ps_ExprContext;
-                    econtext->ecxt_outertuple = node->js.ps.ps_ExprContext;
-                    curtuple = ExecScanHashBucket(node, econtext);
-                    if (curtuple == NULL){
-                        node->hj_InFetched = true;
-                        break;
-                    }
-
-                    inntuple = ExecStoreTuple(curtuple, node->hj_InTupleSlot, InvalidBuffer, false); //Dont free the tuple
-                    econtext->ecxt_innertuple = inntuple;
-                    ResetExprContext(econtext);
-
-                    if (joinqual == NULL || ExecQual(joinqual, econtext, false)) {
-                        if (otherqual == NULL || ExecQual(otherqual, econtext, false)) {
-                            TupleTableSlot *result;
-                            result = ExecProject(node->js.ps.ps_ProjInfo, &isDone);
-                            if (isDone != ExprEndResult) {
-                                node->hj_InProbing = node->hj_InProbing+1;
-                                node->js.ps.ps_TupFromTlist = (isDone == ExprMultipleResult);
-                                return result;
-                            }
-                        }
-                    }
-                }
-                node->hj_NeedNewOuter = true;
-                node->js.ps.ps_OuterTupleSlot = NULL;
-                node->hj_InFetched = true;
-                continue;
-            }
-        }
-    }
-    return NULL;
-}
-
-
-/* ----------------------------------------------------------------
- *		ExecInitHashJoin
- *
- *		Init routine for HashJoin node.
- * ----------------------------------------------------------------
- */
-HashJoinState *
-ExecInitHashJoin(HashJoin *node, EState *estate)
-{
-    HashJoinState *hjstate;
-    Hash *outHashNode; //cSI3130
-    Hash *inHashNode; //CSI3130
-    List	   *lclauses;
-    List	   *rclauses;
-    List	   *hoperators;
-    ListCell   *l;
-
-    /*
-     * create state structure
-     */
-    hjstate = makeNode(HashJoinState);
-    hjstate->js.ps.plan = (Plan *) node;
-    hjstate->js.ps.state = estate;
-
-    /*
-     * Miscellaneous initialization
-     *
-     * create expression context for node
-     */
-    ExecAssignExprContext(estate, &hjstate->js.ps);
-
-    /*
-     * initialize child expressions
-     */
-    hjstate->js.ps.targetlist = (List *)
-            ExecInitExpr((Expr *) node->join.plan.targetlist,
-                         (PlanState *) hjstate);
-    hjstate->js.ps.qual = (List *)
-            ExecInitExpr((Expr *) node->join.plan.qual,
-                         (PlanState *) hjstate);
-    hjstate->js.jointype = node->join.jointype;
-    hjstate->js.joinqual = (List *)
-            ExecInitExpr((Expr *) node->join.joinqual,
-                         (PlanState *) hjstate);
-    hjstate->hashclauses = (List *)
-            ExecInitExpr((Expr *) node->hashclauses,
-                         (PlanState *) hjstate);
-
-    /*
-     * initialize child nodes
-     */
-    outHashNode = (Hash *) outerPlanState(node); //CSI3130
-    inHashNode = (Hash *) innerPlanState(node); //CSI3130
-
-    outerPlanState(hjstate) = ExecInitNode((Plan *) outHashNode, estate); //CSI3130
-    innerPlanState(hjstate) = ExecInitNode((Plan *) inHashNode, estate); //CSI3130
-
-#define HASHJOIN_NSLOTS 3
-
-    /*
-     * tuple table initialization
-     */
-    ExecInitResultTupleSlot(estate, &hjstate->js.ps);
-    hjstate->hj_OuterTupleSlot = ExecInitExtraTupleSlot(estate);
-    hjstate->hj_InTupleSlot = ExecInitExtraTupleSlot(estate); //CSI3130
-
-    switch (node->join.jointype)
-    {
-        case JOIN_INNER:
-        case JOIN_IN:
-            break;
-        case JOIN_LEFT:
-            hjstate->hj_NullInnerTupleSlot =
-                    ExecInitNullTupleSlot(estate, ExecGetResultType(innerPlanState(hjstate)));
-            break;
-        default:
-            elog(ERROR, "unrecognized join type: %d",
-                 (int) node->join.jointype);
-    }
-
-    /*
-     * now for some voodoo.  our temporary tuple slot is actually the result
-     * tuple slot of the Hash node (which is our inner plan).  we do this
-     * because Hash nodes don't return tuples via ExecProcNode() -- instead
-     * the hash join node uses ExecScanHashBucket() to get at the contents of
-     * the hash table.	-cim 6/9/91
-     */
-    {
-        HashState  *hashstate = (HashState *) innerPlanState(hjstate);
-        TupleTableSlot *slot = hashstate->ps.ps_ResultTupleSlot;
-        hjstate->hj_InHashTupleSlot = slot;
-
-        hashstate = (HashState *) outerPlanState(hjstate); //cSI3130
-        slot = hashstate->ps.ps_ResultTupleSlot; //CSi3130
-        hjstate->hj_OutHashTupleSlot = slot; //CSI3130
-    }
-
-    /*
-     * initialize tuple type and projection info
-     */
-    ExecAssignResultTypeFromTL(&hjstate->js.ps);
-    ExecAssignProjectionInfo(&hjstate->js.ps, NULL);
-
-    ExecSetSlotDescriptor(hjstate->hj_OuterTupleSlot, ExecGetResultType(outerPlanState(hjstate)), false);
-    ExecSetSlotDescriptor(hjstate->hj_InTupleSlot, ExecGetResultType(innerPlanState(hjstate)), false); //CSI3130
-
-    /*
-     * initialize hash-specific info
-     */
-    hjstate->hj_InHashTable = NULL; //cSI3130
-    hjstate->hj_FirstOuterTupleSlot = NULL;
-    hjstate->hj_OutHashTable = NULL; //cSI3130
-    hjstate->hj_FirstInTupleSlot = NULL; //CSI3130
-
-    //Changed to In
-    hjstate->hj_InCurHashValue = 0;
-    hjstate->hj_InCurBucketNo = 0;
-    hjstate->hj_InCurTuple = NULL;
-
-
-
-    hjstate->hj_OutCurHashValue = 0; //cSI3130
-    hjstate->hj_OutCurBucketNo = 0; //cSI3130
-    hjstate->hj_OutCurTuple = NULL; //cSI3130
-
-    /*
-     * Deconstruct the hash clauses into outer and inner argument values, so
-     * that we can evaluate those subexpressions separately.  Also make a list
-     * of the hash operator OIDs, in preparation for looking up the hash
-     * functions to use.
-     */
-    lclauses = NULL;
-    rclauses = NULL;
-    hoperators = NULL;
-    foreach(l, hjstate->hashclauses)
-    {
-        FuncExprState *fstate = (FuncExprState *) lfirst(l);
-        OpExpr	   *hclause;
-
-        Assert(IsA(fstate, FuncExprState));
-        hclause = (OpExpr *) fstate->xprstate.expr;
-        Assert(IsA(hclause, OpExpr));
-        lclauses = lappend(lclauses, linitial(fstate->args));
-        rclauses = lappend(rclauses, lsecond(fstate->args));
-        hoperators = lappend_oid(hoperators, hclause->opno);
-    }
-    hjstate->hj_OuterHashKeys = lclauses;
-    hjstate->hj_InnerHashKeys = rclauses;
-    hjstate->hj_HashOperators = hoperators;
-    /* child Hash node needs to evaluate inner hash keys, too */
-    ((HashState *) outerPlanState(hjstate))->hashkeys = rclauses; //CSI3130
-    ((HashState *) innerPlanState(hjstate))->hashkeys = lclauses; //CSI3130
-
-    hjstate->js.ps.ps_OuterTupleSlot = NULL;
-    hjstate->js.ps.ps_InnerTupleSlot = NULL; //csI3130
-    hjstate->hj_NeedNewOuter = true;
-    hjstate->hj_NeedNewIn = true; //cSI3130
-    hjstate->hj_inExauhsted = false; //cSI3130
-    hjstate->hj_outExauhsted = false; //CSI3130
-    hjstate->hj_InProbing = 0; //cSI3130
-    hjstate->hj_OutProbing = 0; //cSI3130
-    hjstate->hj_InFetched = true; //cSI3130
-
-    return hjstate;
-}
-
-int
-ExecCountSlotsHashJoin(HashJoin *node)
-{
-    return ExecCountSlotsNode(outerPlan(node)) +
-           ExecCountSlotsNode(innerPlan(node)) +
-           HASHJOIN_NSLOTS;
-}
-
-/* ----------------------------------------------------------------
- *		ExecEndHashJoin
- *
- *		clean up routine for HashJoin node
- * ----------------------------------------------------------------
- */
-void
-ExecEndHashJoin(HashJoinState *node)
-{
-    /*
-     * Free hash table
-     */
-    if (node->hj_InHashTable) //cSI3130
-    {
-        ExecHashTableDestroy(node->hj_InHashTable); //csi3130
-        node->hj_InHashTable = NULL; //cSi3130
-    }
-
-    if (node->hj_OutHashTable) //csI3130
-    {
-        ExecHashTableDestroy(node->hj_OutHashTable); //csi3130
-        node->hj_OutHashTable = NULL; //cSi3130
-    }
-
-    /*
-     * Free the exprcontext
-     */
-    ExecFreeExprContext(&node->js.ps);
-
-    /*
-     * clean out the tuple table
-     */
-    ExecClearTuple(node->js.ps.ps_InnerTupleSlot); //CSI3130
-    ExecClearTuple(node->js.ps.ps_OuterTupleSlot); //CSI3130
-    ExecClearTuple(node->hj_OuterTupleSlot);
-    ExecClearTuple(node->hj_InTupleSlot); //CSI3130
-    ExecClearTuple(node->hj_InHashTupleSlot); //CSI3130
-    ExecClearTuple(node->hj_OutHashTupleSlot); //CSI3130
-
-    /*
-     * clean up subtrees
-     */
-    ExecEndNode(outerPlanState(node));
-    ExecEndNode(innerPlanState(node));
-}
-
-/*
- * ExecHashJoinOuterGetTuple
- *
- *		get the next outer tuple for hashjoin: either by
- *		executing a plan node in the first pass, or from
- *		the temp files for the hashjoin batches.
- *
- * Returns a null slot if no more outer tuples.  On success, the tuple's
- * hash value is stored at *hashvalue --- this is either originally computed,
- * or re-read from the temp file.
- */
-static TupleTableSlot *
-ExecHashJoinOuterGetTuple(PlanState *outerNode,
-                          HashJoinState *hjstate,
-                          uint32 *hashvalue)
-{
-    HashJoinTable hashtable = hjstate->hj_InHashTable; //CSI3130
-    int			curbatch = hashtable->curbatch;
-    TupleTableSlot *slot;
-
-    if (curbatch == 0)
-    {							/* if it is the first pass */
-
-        /*
-         * Check to see if first outer tuple was already fetched by
-         * ExecHashJoin() and not used yet.
-         */
-        slot = hjstate->hj_FirstOuterTupleSlot;
-        if (!TupIsNull(slot))
-            hjstate->hj_FirstOuterTupleSlot = NULL;
-        else
-            slot = ExecProcNode(outerNode);
-        if (!TupIsNull(slot))
-        {
-            /*
-             * We have to compute the tuple's hash value.
-             */
-            ExprContext *econtext = hjstate->js.ps.ps_ExprContext;
-
-            econtext->ecxt_outertuple = slot;
-            *hashvalue = ExecHashGetHashValue(hashtable, econtext,
-                                              hjstate->hj_OuterHashKeys);
-
-            /* remember outer relation is not empty for possible rescan */
-            //hjstate->hj_OuterNotEmpty = true; //CSI3130 - not needed?
-
-            return slot;
-        }
-
-        /*
-         * We have just reached the end of the first pass. Try to switch to a
-         * saved batch.
-         */
-        curbatch = ExecHashJoinNewBatch(hjstate);
-    }
-
-    /*
-     * Try to read from a temp file. Loop allows us to advance to new batches
-     * as needed.  NOTE: nbatch could increase inside ExecHashJoinNewBatch, so
-     * don't try to optimize this loop.
-     */
-    while (curbatch < hashtable->nbatch)
-    {
-        slot = ExecHashJoinGetSavedTuple(hjstate,
-                                         hashtable->outerBatchFile[curbatch],
-                                         hashvalue,
-                                         hjstate->hj_OuterTupleSlot);
-        if (!TupIsNull(slot))
-            return slot;
-        curbatch = ExecHashJoinNewBatch(hjstate);
-    }
-
-    /* Out of batches... */
-    return NULL;
-}
-
-/*
- * ExecHashJoinNewBatch
- *		switch to a new hashjoin batch
- *
- * Returns the number of the new batch (1..nbatch-1), or nbatch if no more.
- * We will never return a batch number that has an empty outer batch file.
- *
- * CSI3130 method to return 0, based on requirement of the assignment: "Disable the use of multiple batches.
- * In other words assume that the whole hash table consists of one batch that is resident in the memory for
- * the duration of the join processing."
- */
-static int
-ExecHashJoinNewBatch(HashJoinState *hjstate)
-{
-    return 0;
-}
-
-/*
- * ExecHashJoinSaveTuple
- *		save a tuple to a batch file.
- *
- * The data recorded in the file for each tuple is its hash value,
- * then an image of its HeapTupleData (with meaningless t_data pointer)
- * followed by the HeapTupleHeader and tuple data.
- *
- * Note: it is important always to call this in the regular executor
- * context, not in a shorter-lived context; else the temp file buffers
- * will get messed up.
- */
-void
-ExecHashJoinSaveTuple(HeapTuple heapTuple, uint32 hashvalue,
-                      BufFile **fileptr)
-{
-    BufFile    *file = *fileptr;
-    size_t		written;
-
-    if (file == NULL)
-    {
-        /* First write to this batch file, so open it. */
-        file = BufFileCreateTemp(false);
-        *fileptr = file;
-    }
-
-    written = BufFileWrite(file, (void *) &hashvalue, sizeof(uint32));
-    if (written != sizeof(uint32))
-        ereport(ERROR,
-                (errcode_for_file_access(),
-                        errmsg("could not write to hash-join temporary file: %m")));
-
-    written = BufFileWrite(file, (void *) heapTuple, sizeof(HeapTupleData));
-    if (written != sizeof(HeapTupleData))
-        ereport(ERROR,
-                (errcode_for_file_access(),
-                        errmsg("could not write to hash-join temporary file: %m")));
-
-    written = BufFileWrite(file, (void *) heapTuple->t_data, heapTuple->t_len);
-    if (written != (size_t) heapTuple->t_len)
-        ereport(ERROR,
-                (errcode_for_file_access(),
-                        errmsg("could not write to hash-join temporary file: %m")));
-}
-
-/*
- * ExecHashJoinGetSavedTuple
- *		read the next tuple from a batch file.	Return NULL if no more.
- *
- * On success, *hashvalue is set to the tuple's hash value, and the tuple
- * itself is stored in the given slot.
- */
-static TupleTableSlot *
-ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
-                          BufFile *file,
-                          uint32 *hashvalue,
-                          TupleTableSlot *tupleSlot)
-{
-    HeapTupleData htup;
-    size_t		nread;
-    HeapTuple	heapTuple;
-
-    nread = BufFileRead(file, (void *) hashvalue, sizeof(uint32));
-    if (nread == 0)
-        return NULL;			/* end of file */
-    if (nread != sizeof(uint32))
-        ereport(ERROR,
-                (errcode_for_file_access(),
-                        errmsg("could not read from hash-join temporary file: %m")));
-    nread = BufFileRead(file, (void *) &htup, sizeof(HeapTupleData));
-    if (nread != sizeof(HeapTupleData))
-        ereport(ERROR,
-                (errcode_for_file_access(),
-                        errmsg("could not read from hash-join temporary file: %m")));
-    heapTuple = palloc(HEAPTUPLESIZE + htup.t_len);
-    memcpy((char *) heapTuple, (char *) &htup, sizeof(HeapTupleData));
-    heapTuple->t_datamcxt = CurrentMemoryContext;
-    heapTuple->t_data = (HeapTupleHeader)
-            ((char *) heapTuple + HEAPTUPLESIZE);
-    nread = BufFileRead(file, (void *) heapTuple->t_data, htup.t_len);
-    if (nread != (size_t) htup.t_len)
-        ereport(ERROR,
-                (errcode_for_file_access(),
-                        errmsg("could not read from hash-join temporary file: %m")));
-    return ExecStoreTuple(heapTuple, tupleSlot, InvalidBuffer, true);
-}
-
-
-void
-ExecReScanHashJoin(HashJoinState *node, ExprContext *exprCtxt)
-{
-    /*
-     * In a multi-batch join, we currently have to do rescans the hard way,
-     * primarily because batch temp files may have already been released. But
-     * if it's a single-batch join, and there is no parameter change for the
-     * inner subnode, then we can just re-use the existing hash table without
-     * rebuilding it.
-     */
-    if (node->hj_InHashTable!= NULL)
-    {
-        if (node->hj_InHashTable->nbatch == 1 &&
-            ((PlanState *) node)->righttree->chgParam == NULL)
-        {
-            /*
-             * okay to reuse the hash table; needn't rescan inner, either.
-             *
-             * What we do need to do is reset our state about the emptiness
-             * of the outer relation, so that the new scan of the outer will
-             * update it correctly if it turns out to be empty this time.
-             * (There's no harm in clearing it now because ExecHashJoin won't
-             * need the info.  In the other cases, where the hash table
-             * doesn't exist or we are destroying it, we leave this state
-             * alone because ExecHashJoin will need it the first time
-             * through.)
-             */
-            //CSI3130
-            //node->hj_OuterNotEmpty = false;
-        }
-        else
-        {
-            /* must destroy and rebuild hash table */
-            ExecHashTableDestroy(node->hj_InHashTable);
-            node->hj_InHashTable = NULL;
-
-            /*
-             * if chgParam of subnode is not null then plan will be re-scanned
-             * by first ExecProcNode.
-             */
-            if (((PlanState *) node)->righttree->chgParam == NULL)
-                ExecReScan(((PlanState *) node)->righttree, exprCtxt);
-        }
-    }
-
-    //CSI3130
-/*
-    */
-/* Always reset intra-tuple state *//*
-
-    node->hj_CurHashValue = 0;
-    node->hj_CurBucketNo = 0;
-    node->hj_CurTuple = NULL;
-*/
-
-    node->js.ps.ps_OuterTupleSlot = NULL;
-    node->js.ps.ps_TupFromTlist = false;
-    node->hj_NeedNewOuter = true;
-    node->hj_MatchedOuter = false;
-    node->hj_FirstOuterTupleSlot = NULL;
-
-    /*
-     * if chgParam of subnode is not null then plan will be re-scanned by
-     * first ExecProcNode.
-     */
-    if (((PlanState *) node)->lefttree->chgParam == NULL)
-        ExecReScan(((PlanState *) node)->lefttree, exprCtxt);
-}
+/*-------------------------------------------------------------------------
+ *
+ * nodeHashjoin.c
+ *	  Routines to handle hash join nodes
+ *
+ * Portions Copyright (c) 1996-2005, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  $PostgreSQL: pgsql/src/backend/executor/nodeHashjoin.c,v 1.75.2.4 2007/02/02 00:07:44 tgl Exp $
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "access/hash.h"
+#include "access/skey.h"
+#include "access/xact.h"
+#include "catalog/pg_am.h"
+#include "executor/executor.h"
+#include "executor/hashjoin.h"
+#include "executor/nodeHash.h"
+#include "executor/nodeHashjoin.h"
+#include "optimizer/clauses.h"
+#include "parser/parsetree.h"
+#include "storage/fd.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "nodes/execnodes.h"
+#include "../../include/nodes/execnodes.h"
+#include "../../include/executor/hashjoin.h"
+
+
+static TupleTableSlot *ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
+                                                 HashJoinBatchFile file,
+                                                 uint32 *hashvalue,
+                                                 TupleTableSlot *tupleSlot);
+static bool ExecHashJoinNewBatch(HashJoinState *hjstate);
+static TupleTableSlot *ExecHashJoinBatches(HashJoinState *node);
+static void ExecHashJoinLoadChunk(HashJoinState *hjstate);
+static bool ExecHashJoinChooseInput(HashJoinState *node);
+static TupleTableSlot *ExecHashJoinFetch(HashJoinState *node, bool inner);
+static void ExecHashJoinInitPurge(HashJoinState *node);
+static bool ExecHashJoinInputOrdered(HashState *hashNode, Oid sortop);
+static void ExecHashJoinPunctuate(HashJoinState *node, bool inner);
+static HashJoinSavedState *ExecHashJoinClaimState(HashJoinState *node);
+static void ExecHashJoinReleaseState(HashJoinState *node, bool keep);
+static bool ExecHashJoinSameRowType(TupleDesc desc1, TupleDesc desc2);
+static void ExecHashJoinDropState(HashJoinSavedState *state);
+static void ExecHashJoinStateXactCallback(XactEvent event, void *arg);
+static void ExecHashJoinStateSubXactCallback(SubXactEvent event,
+                                             SubTransactionId mySubid,
+                                             SubTransactionId parentSubid,
+                                             void *arg);
+static uint32 ExecHashJoinSignature(HashJoinState *node);
+static bool ExecHashJoinClaimCheckpoint(HashJoinState *node);
+static void ExecHashJoinReleaseCheckpoint(HashJoinState *node, bool remove);
+static void ExecHashJoinCheckpointXactCallback(XactEvent event, void *arg);
+static void ExecHashJoinMapPosition(HashJoinState *node);
+static void ExecHashJoinUnmapPosition(void);
+static bool ExecHashJoinEmitRow(HashJoinState *node);
+static void ExecHashJoinCheckpointIfDue(HashJoinState *node);
+static void ExecHashJoinCheckpoint(HashJoinState *node);
+static void ExecHashJoinCheckpointTable(FILE *file, const char *path,
+                                        HashJoinTable hashtable);
+static HashJoinTuple ExecHashJoinReverseChain(HashJoinTuple hashTuple);
+static void ExecHashJoinCheckpointTuple(FILE *file, const char *path,
+                                        HeapTuple tuple, uint32 hashvalue);
+static void ExecHashJoinCheckpointWrite(FILE *file, const char *path,
+                                        void *data, size_t len);
+static void ExecHashJoinResume(HashJoinState *node);
+static void ExecHashJoinResumeTable(FILE *file, const char *path,
+                                    HashJoinTable hashtable);
+static void ExecHashJoinResumeRead(FILE *file, const char *path,
+                                   void *data, size_t len);
+static void ExecHashJoinSkipRows(HashState *hashNode, double nrows);
+static void ExecHashJoinReportStats(HashJoinState *node);
+
+
+/* ----------------------------------------------------------------
+ *		ExecHashJoin
+ *
+ *		This function implements the Hybrid Hashjoin algorithm.
+ *
+ *		Note: the relation we build hash table on is the "inner"
+ *			  the other one is "outer".
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *				/* return: a tuple or NULL */
+ExecHashJoin(HashJoinState *node)
+{
+    EState	   *estate;
+    HashState  *outHashNode; //CSI3130
+    HashState  *inHashNode; //cSI3130
+    List	   *joinqual;
+    List	   *otherqual;
+    TupleTableSlot *inntuple;
+    TupleTableSlot *outtuple; //CSI3130
+    ExprContext *econtext;
+    ExprDoneCond isDone;
+    HashJoinTable inhashtable; //CSI3130
+    HashJoinTable outhashtable; //CSI3130
+    HeapTuple	curtuple;
+    TupleTableSlot *outerTupleSlot;
+    TupleTableSlot *innerTupleSlot; //CSI3130
+    uint32		hashvalue;
+    int			batchno;
+
+    /*
+     * get information from HashJoin node
+     */
+    estate = node->js.ps.state;
+    joinqual = node->js.joinqual;
+    otherqual = node->js.ps.qual;
+    inHashNode = (HashState *) innerPlanState(node);
+    outHashNode = (HashState *) outerPlanState(node); //CSI3130
+
+
+    /*
+     * get information from HashJoin state
+     */
+    inhashtable = node->hj_InHashTable; //CSI3130
+    outhashtable = node->hj_OutHashTable; //CSI3130
+    econtext = node->js.ps.ps_ExprContext;
+
+    /*
+     * Check to see if we're still projecting out tuples from a previous join
+     * tuple (because there is a function-returning-set in the projection
+     * expressions).  If so, try to project another one.
+     */
+    /*CSI3130
+     *  Do w need this?*/
+//    if (node->js.ps.ps_TupFromTlist)
+//    {
+//        TupleTableSlot *result;
+//
+//        result = ExecProject(node->js.ps.ps_ProjInfo, &isDone);
+//        if (isDone == ExprMultipleResult)
+//            return result;
+//        /* Done with that source tuple... */
+//        node->js.ps.ps_TupFromTlist = false;
+//    }
+
+    /*
+     * If we're doing an IN join, we want to return at most one row per outer
+     * tuple; so we can stop scanning the inner scan if we matched on the
+     * previous try.
+     */
+    if (node->js.jointype == JOIN_IN && node->hj_MatchedOuter)
+        node->hj_NeedNewOuter = true;
+
+    /*
+     * Reset per-tuple memory context to free any expression evaluation
+     * storage allocated in the previous tuple cycle.  Note this can't happen
+     * until we're done projecting out tuples from a join tuple.
+     */
+    ResetExprContext(econtext);
+
+    /*
+     * if this is the first call, build the hash table for inner relation
+     */
+    if (inhashtable == NULL && outhashtable == NULL) //CSI3130
+    {
+        bool        checkpointing;
+
+        /*
+         * If the outer relation is completely empty, we can quit without
+         * building the hash table.  However, for an inner join it is only a
+         * win to check this when the outer relation's startup cost is less
+         * than the projected cost of building the hash table.	Otherwise it's
+         * best to build the hash table first and see if the inner relation is
+         * empty.  (When it's an outer join, we should always make this check,
+         * since we aren't going to be able to skip the join on the strength
+         * of an empty inner relation anyway.)
+         *
+         * If we are rescanning the join, we make use of information gained
+         * on the previous scan: don't bother to try the prefetch if the
+         * previous scan found the outer relation nonempty.  This is not
+         * 100% reliable since with new parameters the outer relation might
+         * yield different results, but it's a good heuristic.
+         *
+         * The only way to make the check is to try to fetch a tuple from the
+         * outer plan node.  If we succeed, we have to stash it away for later
+         * consumption by ExecHashJoinOuterGetTuple.
+         */
+        //CSI3130 - Not needed?
+//        if (node->js.jointype == JOIN_LEFT ||
+//            (outerNode->plan->startup_cost < hashNode->ps.plan->total_cost &&
+//             !node->hj_OuterNotEmpty))
+//        {
+//            node->hj_FirstOuterTupleSlot = ExecProcNode(outerNode);
+//            if (TupIsNull(node->hj_FirstOuterTupleSlot))
+//            {
+//                node->hj_OuterNotEmpty = false;
+//                return NULL;
+//            }
+//            else
+//                node->hj_OuterNotEmpty = true;
+//        }
+//        else
+//            node->hj_FirstOuterTupleSlot = NULL;
+
+        /*
+         * Under hashjoin_state_name, pick up the tables a previous run of
+         * this join left behind, if any; they already hold everything that
+         * run read, so only the new rows' results come out of this one.
+         */
+        if (hashjoin_state_name != NULL && hashjoin_state_name[0] != '\0' &&
+            node->js.jointype == JOIN_INNER)
+            node->hj_SavedState = ExecHashJoinClaimState(node);
+
+        checkpointing = (node->hj_SavedState == NULL &&
+                         hashjoin_checkpoint_file != NULL &&
+                         hashjoin_checkpoint_file[0] != '\0' &&
+                         ExecHashJoinClaimCheckpoint(node));
+
+        if (node->hj_SavedState != NULL &&
+            node->hj_SavedState->intable != NULL)
+        {
+            inhashtable = node->hj_SavedState->intable;
+            outhashtable = node->hj_SavedState->outtable;
+        }
+        else
+        {
+            bool        persistent = (node->hj_SavedState != NULL);
+
+            /*
+             * create the hash table
+             */
+            inhashtable = ExecHashTableCreate((Hash *) inHashNode->ps.plan,
+                                              node->hj_HashOperators,
+                                              persistent,
+                                              checkpointing); //CSI3130
+            outhashtable = ExecHashTableCreate((Hash *) outHashNode->ps.plan,
+                                               node->hj_HashOperators,
+                                               persistent,
+                                               checkpointing); //cSI3130
+            ExecHashTableLink(outhashtable, inhashtable);
+
+            /*
+             * Store only key columns and TIDs for wide base-relation inputs
+             * whose tuples are not expected to find many matches.  (Not for
+             * persistent or checkpointed state: later runs may read other
+             * relations, or the same ones after they have been changed.)
+             */
+            if (!persistent && !checkpointing)
+            {
+                ExecHashLateMaterialize(inhashtable, inHashNode,
+                                        node->js.ps.plan->plan_rows);
+                ExecHashLateMaterialize(outhashtable, outHashNode,
+                                        node->js.ps.plan->plan_rows);
+            }
+
+            /*
+             * Give the most common key values of either input their own
+             * in-memory buckets in both tables.
+             */
+            ExecHashBuildSkewHash(outhashtable, outHashNode,
+                                  inhashtable, inHashNode);
+
+            if (persistent)
+            {
+                node->hj_SavedState->intable = inhashtable;
+                node->hj_SavedState->outtable = outhashtable;
+            }
+        }
+        node->hj_InHashTable = inhashtable;
+        node->hj_OutHashTable = outhashtable; //CSI3130
+
+        /* time the batch file I/O only if anyone will see the times */
+        inhashtable->spillStats.timing = (node->js.ps.instrument != NULL);
+        outhashtable->spillStats.timing = (node->js.ps.instrument != NULL);
+
+        /*
+         * execute the Hash node, to build the hash table
+         */
+        inHashNode->hashtable = inhashtable; //CSI3130
+        outHashNode->hashtable = outhashtable; //CSI3130
+
+        /*
+         * If either input is known to arrive in join key order, arrange to
+         * purge the entries it can no longer match from the other table.
+         * Persistent state must keep every entry for the runs to come.
+         */
+        if (node->hj_SavedState == NULL)
+            ExecHashJoinInitPurge(node);
+
+        /*
+         * Pick up where an earlier run of this join was interrupted, if it
+         * left a checkpoint, and schedule the next checkpoint.
+         */
+        if (checkpointing)
+        {
+            ExecHashJoinResume(node);
+            node->hj_CheckpointAt = node->hj_InRead + node->hj_OutRead +
+                Max(hashjoin_checkpoint_interval, 1);
+        }
+
+        //(void) MultiExecProcNode((PlanState *) hashNode); //CSI3130 - not needed?
+
+        /*
+         * If the inner relation is completely empty, and we're not doing an
+         * outer join, we can quit without scanning the outer relation.
+         */
+        //CSI3130 - not needed?
+//        if (hashtable->totalTuples == 0 && node->js.jointype != JOIN_LEFT)
+//            return NULL;
+
+        /*
+         * need to remember whether nbatch has increased since we began
+         * scanning the outer relation
+         */ //CSI3130 - not needed?
+        //hashtable->nbatch_outstart = hashtable->nbatch;
+
+        /*
+         * Reset OuterNotEmpty for scan.  (It's OK if we fetched a tuple
+         * above, because ExecHashJoinOuterGetTuple will immediately
+         * set it again.)
+         */
+        //node->hj_OuterNotEmpty = false; //CSI3130 not needed?
+    }
+    /*
+     * once both inputs have ended, only the spilled batches are left
+     */
+    if (node->hj_inExauhsted && node->hj_outExauhsted)
+        return ExecHashJoinBatches(node);
+
+    /*
+     * run the hash join process
+     * CSI3130
+     */
+    for (;;)
+    {
+        if(!node->hj_inExauhsted || !node->hj_outExauhsted){
+            if(node->hj_inExauhsted)
+                node->hj_InFetched = false;
+            if(node->hj_outExauhsted)
+                node->hj_InFetched = true;
+
+            if (!node->hj_inExauhsted && node->hj_NeedNewIn && node->hj_InFetched) {
+                innerTupleSlot = ExecHashJoinFetch(node, true);
+                node->js.ps.ps_InnerTupleSlot = innerTupleSlot;
+
+                if (!TupIsNull(innerTupleSlot)) {
+
+                    node->hj_NeedNewIn = false;
+                    node->hj_InRead += 1;
+
+                    // Set the econtext, a lot of functions can only see the tuple if put into econtext
+                    econtext = node->js.ps.ps_ExprContext;
+                    econtext->ecxt_innertuple = innerTupleSlot;
+
+                    // Get hash values of inner tuple
+                    hashvalue = ExecHashGetHashValue(outhashtable, econtext, node->hj_InnerHashKeys);
+
+                    // An ordered inner input never returns a smaller key again
+                    if (node->hj_InPurgeFn != NULL)
+                        ExecHashJoinPunctuate(node, true);
+
+                    // Reset the current inner tuple
+                    node->js.ps.ps_InnerTupleSlot = innerTupleSlot;
+                    // Set the econtext
+                    econtext->ecxt_innertuple = node->js.ps.ps_InnerTupleSlot;
+
+                    // Find corresponding bucket, unless the filter says there is none
+                    // (hot keys have all their tuples in a skew bucket instead,
+                    // and one of a batch the other table flushed is joined once both inputs end)
+                    node->hj_InCurHashValue = hashvalue;
+                    node->hj_OutCurSkewBucketNo = ExecHashGetSkewBucket(outhashtable, hashvalue);
+                    if (node->hj_OutCurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
+                        node->hj_OutCurBucketNo = HJ_NO_BUCKET;
+                    else
+                    {
+                        ExecHashGetBucketAndBatch(outhashtable, hashvalue, &node->hj_OutCurBucketNo, &batchno);
+                        if (!HJ_BATCH_IN_MEMORY(outhashtable, batchno) ||
+                            !ExecHashBloomTest(outhashtable, hashvalue))
+                            node->hj_OutCurBucketNo = HJ_NO_BUCKET;
+                    }
+                    node->hj_OutCurTuple = NULL;
+
+                } else {
+
+                    node->hj_inExauhsted = true;
+
+                    /*
+                     * the inner key set is now complete; filter the outer
+                     * input (unless its rows must all go into saved state)
+                     */
+                    if (node->js.jointype != JOIN_LEFT &&
+                        node->hj_SavedState == NULL)
+                        outHashNode->filtertable = inhashtable;
+                }
+            }
+
+            if (!node->hj_outExauhsted && node->hj_NeedNewOuter  && !node->hj_InFetched) {
+                outerTupleSlot = ExecHashJoinFetch(node, false);
+                node->js.ps.ps_OuterTupleSlot = outerTupleSlot;
+
+                if (!TupIsNull(outerTupleSlot)) {
+
+                    node->hj_NeedNewOuter = false;
+                    node->hj_OutRead += 1;
+
+                    // Set the econtext, a lot of functions can only see the tuple if put into econtext
+                    econtext = node->js.ps.ps_ExprContext;
+                    econtext->ecxt_outertuple = outerTupleSlot;
+
+                    // Get hash values of inner tuple
+                    hashvalue = ExecHashGetHashValue(inhashtable, econtext, node->hj_OuterHashKeys);
+
+                    // An ordered outer input never returns a smaller key again
+                    if (node->hj_OutPurgeFn != NULL)
+                        ExecHashJoinPunctuate(node, false);
+
+                    // Reset the current outer tuple
+                    node->js.ps.ps_OuterTupleSlot = outerTupleSlot;
+                    econtext->ecxt_outertuple = node->js.ps.ps_OuterTupleSlot;
+
+                    // Find corresponding bucket, unless the filter says there is none
+                    // (hot keys have all their tuples in a skew bucket instead,
+                    // and one of a batch the other table flushed is joined once both inputs end)
+                    node->hj_OutCurHashValue = hashvalue;
+                    node->hj_InCurSkewBucketNo = ExecHashGetSkewBucket(inhashtable, hashvalue);
+                    if (node->hj_InCurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
+                        node->hj_InCurBucketNo = HJ_NO_BUCKET;
+                    else
+                    {
+                        ExecHashGetBucketAndBatch(inhashtable, hashvalue, &node->hj_InCurBucketNo, &batchno);
+                        if (!HJ_BATCH_IN_MEMORY(inhashtable, batchno) ||
+                            !ExecHashBloomTest(inhashtable, hashvalue))
+                            node->hj_InCurBucketNo = HJ_NO_BUCKET;
+                    }
+                    node->hj_InCurTuple = NULL;
+
+                } else {
+
+                    node->hj_outExauhsted = true;
+
+                    /* the outer key set is now complete; filter the inner input */
+                    if (node->hj_SavedState == NULL)
+                        inHashNode->filtertable = outhashtable;
+                }
+            }
+
+            if (node->hj_inExauhsted && node->hj_outExauhsted)
+            {
+                /* the join is complete, so its checkpoint is of no more use */
+                if (node->hj_CheckpointAt > 0)
+                    ExecHashJoinReleaseCheckpoint(node, true);
+                return ExecHashJoinBatches(node);
+            }
+
+            if (!TupIsNull(node->js.ps.ps_InnerTupleSlot) && node->hj_InFetched) {
+
+                for (;;) {
+                    ExprContext *econtext = node->js.ps.ps_ExprContext;
+                    econtext->ecxt_innertuple = node->js.ps.ps_InnerTupleSlot;
+                    curtuple = ExecScanHashBucket(node, econtext);
+                    if (curtuple == NULL)
+                        break;
+
+
+                    /*
+                     * we've got a match, but still need to test non-hashed quals
+                    */
+                    outtuple = ExecHashStoreMatch(outhashtable, curtuple,
+                                                  node->hj_OuterTupleSlot, estate);
+                    econtext->ecxt_outertuple = outtuple;
+
+                    /* reset temp memory each time to avoid leaks from qual expr */
+                    ResetExprContext(econtext);
+
+                    /*
+                    * if we pass the qual, then save state for next call and have
+                    * ExecProject form the projection, store it in the tuple table,
+                    * and return the slot.
+                    *
+                    * Only the joinquals determine MatchedOuter status, but all quals
+                    * must pass to actually return the tuple.
+                    */
+                    if (joinqual == NIL || ExecQual(joinqual, econtext, false)) {
+                        if (otherqual == NIL || ExecQual(otherqual, econtext, false)) {
+                            TupleTableSlot *result;
+                            result = ExecProject(node->js.ps.ps_ProjInfo, &isDone);
+                            if (isDone != ExprEndResult && ExecHashJoinEmitRow(node)) {
+                                node->hj_OutProbing=node->hj_OutProbing+1;
+                                node->js.ps.ps_TupFromTlist = (isDone == ExprMultipleResult);
+                                return result;
+                            }
+                        }
+                    }
+                }
+                node->hj_NeedNewIn = true;
+                node->js.ps.ps_InnerTupleSlot = NULL;
+                node->hj_InFetched = ExecHashJoinChooseInput(node);
+
+                /* between tuples is the one place a checkpoint is consistent */
+                if (node->hj_CheckpointAt > 0)
+                    ExecHashJoinCheckpointIfDue(node);
+                continue;
+            }
+
+            if(!TupIsNull(node->js.ps.ps_OuterTupleSlot) && !node->hj_InFetched){
+                for(;;) {
+                    ExprContext *econtext = node->js.ps.ps_ExprContext;
+                    econtext->ecxt_outertuple = node->js.ps.ps_OuterTupleSlot;
+                    curtuple = ExecScanHashBucket(node, econtext);
+                    if (curtuple == NULL)
+                        break;
+
+                    inntuple = ExecHashStoreMatch(inhashtable, curtuple,
+                                                  node->hj_InTupleSlot, estate);
+                    econtext->ecxt_innertuple = inntuple;
+                    ResetExprContext(econtext);
+
+                    if (joinqual == NULL || ExecQual(joinqual, econtext, false)) {
+                        if (otherqual == NULL || ExecQual(otherqual, econtext, false)) {
+                            TupleTableSlot *result;
+                            result = ExecProject(node->js.ps.ps_ProjInfo, &isDone);
+                            if (isDone != ExprEndResult && ExecHashJoinEmitRow(node)) {
+                                node->hj_InProbing = node->hj_InProbing+1;
+                                node->js.ps.ps_TupFromTlist = (isDone == ExprMultipleResult);
+                                return result;
+                            }
+                        }
+                    }
+                }
+                node->hj_NeedNewOuter = true;
+                node->js.ps.ps_OuterTupleSlot = NULL;
+                node->hj_InFetched = ExecHashJoinChooseInput(node);
+
+                /* between tuples is the one place a checkpoint is consistent */
+                if (node->hj_CheckpointAt > 0)
+                    ExecHashJoinCheckpointIfDue(node);
+                continue;
+            }
+        }
+    }
+    return NULL;
+}
+
+
+/* ----------------------------------------------------------------
+ *		ExecInitHashJoin
+ *
+ *		Init routine for HashJoin node.
+ * ----------------------------------------------------------------
+ */
+HashJoinState *
+ExecInitHashJoin(HashJoin *node, EState *estate)
+{
+    HashJoinState *hjstate;
+    Hash *outHashNode; //cSI3130
+    Hash *inHashNode; //CSI3130
+    List	   *lclauses;
+    List	   *rclauses;
+    List	   *hoperators;
+    ListCell   *l;
+
+    /*
+     * create state structure
+     */
+    hjstate = makeNode(HashJoinState);
+    hjstate->js.ps.plan = (Plan *) node;
+    hjstate->js.ps.state = estate;
+
+    /*
+     * Miscellaneous initialization
+     *
+     * create expression context for node
+     */
+    ExecAssignExprContext(estate, &hjstate->js.ps);
+
+    /*
+     * initialize child expressions
+     */
+    hjstate->js.ps.targetlist = (List *)
+            ExecInitExpr((Expr *) node->join.plan.targetlist,
+                         (PlanState *) hjstate);
+    hjstate->js.ps.qual = (List *)
+            ExecInitExpr((Expr *) node->join.plan.qual,
+                         (PlanState *) hjstate);
+    hjstate->js.jointype = node->join.jointype;
+    hjstate->js.joinqual = (List *)
+            ExecInitExpr((Expr *) node->join.joinqual,
+                         (PlanState *) hjstate);
+    hjstate->hashclauses = (List *)
+            ExecInitExpr((Expr *) node->hashclauses,
+                         (PlanState *) hjstate);
+
+    /*
+     * initialize child nodes
+     */
+    outHashNode = (Hash *) outerPlan(node); //CSI3130
+    inHashNode = (Hash *) innerPlan(node); //CSI3130
+
+    outerPlanState(hjstate) = ExecInitNode((Plan *) outHashNode, estate); //CSI3130
+    innerPlanState(hjstate) = ExecInitNode((Plan *) inHashNode, estate); //CSI3130
+
+#define HASHJOIN_NSLOTS 3
+
+    /*
+     * tuple table initialization
+     */
+    ExecInitResultTupleSlot(estate, &hjstate->js.ps);
+    hjstate->hj_OuterTupleSlot = ExecInitExtraTupleSlot(estate);
+    hjstate->hj_InTupleSlot = ExecInitExtraTupleSlot(estate); //CSI3130
+
+    switch (node->join.jointype)
+    {
+        case JOIN_INNER:
+        case JOIN_IN:
+            break;
+        case JOIN_LEFT:
+            hjstate->hj_NullInnerTupleSlot =
+                    ExecInitNullTupleSlot(estate, ExecGetResultType(innerPlanState(hjstate)));
+            break;
+        default:
+            elog(ERROR, "unrecognized join type: %d",
+                 (int) node->join.jointype);
+    }
+
+    /*
+     * now for some voodoo.  our temporary tuple slot is actually the result
+     * tuple slot of the Hash node (which is our inner plan).  we do this
+     * because Hash nodes don't return tuples via ExecProcNode() -- instead
+     * the hash join node uses ExecScanHashBucket() to get at the contents of
+     * the hash table.	-cim 6/9/91
+     */
+    {
+        HashState  *hashstate = (HashState *) innerPlanState(hjstate);
+        TupleTableSlot *slot = hashstate->ps.ps_ResultTupleSlot;
+        hjstate->hj_InHashTupleSlot = slot;
+
+        hashstate = (HashState *) outerPlanState(hjstate); //cSI3130
+        slot = hashstate->ps.ps_ResultTupleSlot; //CSi3130
+        hjstate->hj_OutHashTupleSlot = slot; //CSI3130
+    }
+
+    /*
+     * initialize tuple type and projection info
+     */
+    ExecAssignResultTypeFromTL(&hjstate->js.ps);
+    ExecAssignProjectionInfo(&hjstate->js.ps, NULL);
+
+    ExecSetSlotDescriptor(hjstate->hj_OuterTupleSlot, ExecGetResultType(outerPlanState(hjstate)), false);
+    ExecSetSlotDescriptor(hjstate->hj_InTupleSlot, ExecGetResultType(innerPlanState(hjstate)), false); //CSI3130
+
+    /*
+     * initialize hash-specific info
+     */
+    hjstate->hj_InHashTable = NULL; //cSI3130
+    hjstate->hj_FirstOuterTupleSlot = NULL;
+    hjstate->hj_OutHashTable = NULL; //cSI3130
+    hjstate->hj_FirstInTupleSlot = NULL; //CSI3130
+
+    //Changed to In
+    hjstate->hj_InCurHashValue = 0;
+    hjstate->hj_InCurBucketNo = 0;
+    hjstate->hj_InCurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
+    hjstate->hj_InCurTuple = NULL;
+
+
+
+    hjstate->hj_OutCurHashValue = 0; //cSI3130
+    hjstate->hj_OutCurBucketNo = 0; //cSI3130
+    hjstate->hj_OutCurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
+    hjstate->hj_OutCurTuple = NULL; //cSI3130
+
+    /*
+     * Deconstruct the hash clauses into outer and inner argument values, so
+     * that we can evaluate those subexpressions separately.  Also make a list
+     * of the hash operator OIDs, in preparation for looking up the hash
+     * functions to use.
+     */
+    lclauses = NULL;
+    rclauses = NULL;
+    hoperators = NULL;
+    foreach(l, hjstate->hashclauses)
+    {
+        FuncExprState *fstate = (FuncExprState *) lfirst(l);
+        OpExpr	   *hclause;
+
+        Assert(IsA(fstate, FuncExprState));
+        hclause = (OpExpr *) fstate->xprstate.expr;
+        Assert(IsA(hclause, OpExpr));
+        lclauses = lappend(lclauses, linitial(fstate->args));
+        rclauses = lappend(rclauses, lsecond(fstate->args));
+        hoperators = lappend_oid(hoperators, hclause->opno);
+    }
+    hjstate->hj_OuterHashKeys = lclauses;
+    hjstate->hj_InnerHashKeys = rclauses;
+    hjstate->hj_HashOperators = hoperators;
+    /* each child Hash node evaluates its own side's hash keys */
+    ((HashState *) outerPlanState(hjstate))->hashkeys = lclauses; //CSI3130
+    ((HashState *) innerPlanState(hjstate))->hashkeys = rclauses; //CSI3130
+
+    hjstate->js.ps.ps_OuterTupleSlot = NULL;
+    hjstate->js.ps.ps_InnerTupleSlot = NULL; //csI3130
+    hjstate->hj_NeedNewOuter = true;
+    hjstate->hj_NeedNewIn = true; //cSI3130
+    hjstate->hj_inExauhsted = false; //cSI3130
+    hjstate->hj_outExauhsted = false; //CSI3130
+    hjstate->hj_InProbing = 0; //cSI3130
+    hjstate->hj_OutProbing = 0; //cSI3130
+    hjstate->hj_InRead = 0;
+    hjstate->hj_OutRead = 0;
+    hjstate->hj_InTime = 0;
+    hjstate->hj_OutTime = 0;
+    hjstate->hj_InFetched = true; //cSI3130
+    hjstate->hj_InPurgeFn = NULL;	/* see ExecHashJoinInitPurge */
+    hjstate->hj_OutPurgeFn = NULL;
+    hjstate->hj_InPurgeAt = 0;
+    hjstate->hj_OutPurgeAt = 0;
+    hjstate->hj_SavedState = NULL;	/* see ExecHashJoinClaimState */
+    hjstate->hj_CheckpointFile = NULL;	/* see ExecHashJoinCheckpoint */
+    hjstate->hj_CheckpointAt = 0;
+    hjstate->hj_RowsReturned = 0;
+    hjstate->hj_RowsResumed = 0;
+    hjstate->hj_ProbeJoined = false;	/* see ExecHashJoinBatches */
+    hjstate->hj_ProbeFetched = false;
+    hjstate->hj_BatchFileNo = 0;
+    hjstate->hj_BatchesJoined = 0;
+    hjstate->hj_BuildFileNo = 0;
+    hjstate->hj_BatchChunks = 0;
+    hjstate->hj_ExtraChunks = 0;
+
+    return hjstate;
+}
+
+int
+ExecCountSlotsHashJoin(HashJoin *node)
+{
+    return ExecCountSlotsNode(outerPlan(node)) +
+           ExecCountSlotsNode(innerPlan(node)) +
+           HASHJOIN_NSLOTS;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndHashJoin
+ *
+ *		clean up routine for HashJoin node
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndHashJoin(HashJoinState *node)
+{
+    /*
+     * Under EXPLAIN ANALYZE, report what the hash tables did (at DEBUG1)
+     */
+    if (node->js.ps.instrument)
+        ExecHashJoinReportStats(node);
+
+    /* an unfinished join leaves its checkpoint behind to resume from */
+    ExecHashJoinReleaseCheckpoint(node, false);
+
+    /*
+     * Persistent state is only worth keeping if both inputs were read to
+     * the end; otherwise later runs would miss matches for the rows we
+     * never got to.  Either way the tables are no longer ours to free.
+     */
+    if (node->hj_SavedState != NULL)
+    {
+        ExecHashJoinReleaseState(node,
+                                 node->hj_inExauhsted && node->hj_outExauhsted);
+        node->hj_InHashTable = NULL;
+        node->hj_OutHashTable = NULL;
+    }
+
+    /*
+     * Free hash table
+     */
+    if (node->hj_InHashTable) //cSI3130
+    {
+        ExecHashTableDestroy(node->hj_InHashTable); //csi3130
+        node->hj_InHashTable = NULL; //cSi3130
+    }
+
+    if (node->hj_OutHashTable) //csI3130
+    {
+        ExecHashTableDestroy(node->hj_OutHashTable); //csi3130
+        node->hj_OutHashTable = NULL; //cSi3130
+    }
+
+    /*
+     * Free the exprcontext
+     */
+    ExecFreeExprContext(&node->js.ps);
+
+    /*
+     * clean out the tuple table
+     */
+    ExecClearTuple(node->js.ps.ps_InnerTupleSlot); //CSI3130
+    ExecClearTuple(node->js.ps.ps_OuterTupleSlot); //CSI3130
+    ExecClearTuple(node->hj_OuterTupleSlot);
+    ExecClearTuple(node->hj_InTupleSlot); //CSI3130
+    ExecClearTuple(node->hj_InHashTupleSlot); //CSI3130
+    ExecClearTuple(node->hj_OutHashTupleSlot); //CSI3130
+
+    /*
+     * clean up subtrees
+     */
+    ExecEndNode(outerPlanState(node));
+    ExecEndNode(innerPlanState(node));
+}
+
+/*
+ * ExecHashJoinChooseInput
+ *
+ *		decide which input the symmetric join reads its next tuple from;
+ *		returns true for the inner input, false for the outer one
+ *
+ * Rather than strictly alternating, we route reads adaptively, eddy style:
+ * each input's observed match rate (join rows produced per tuple read from
+ * it, hj_OutProbing/hj_InRead for the inner input and hj_InProbing/
+ * hj_OutRead for the outer one) decides which side is read next, so the
+ * side whose tuples currently produce more output gets more of the reads
+ * and output flows as early as possible.  To keep both estimates fresh,
+ * and to guarantee progress on both inputs, neither side may fall below
+ * 1/HJ_SCHED_MIN_SHARE of the reads.
+ *
+ * The rates are per second rather than per tuple: each match rate is
+ * divided by the average time a fetch from that input has taken (see
+ * ExecHashJoinFetch).  An input that stalls, e.g. one reading cold data
+ * from disk or waiting on a remote source, is then read less often, while
+ * the other input keeps the join producing rows.  HJ_SCHED_MIN_COST keeps
+ * a side with no timings yet from looking infinitely fast.  A checkpointed
+ * join goes by the counts alone, so that a resumed run reads its inputs in
+ * the same order as the interrupted one (see Checkpoints below).
+ */
+#define HJ_SCHED_MIN_SHARE	8
+#define HJ_SCHED_MIN_COST	1.0e-6	/* seconds */
+
+static bool
+ExecHashJoinChooseInput(HashJoinState *node)
+{
+    double      inrate;
+    double      outrate;
+
+    if (node->hj_inExauhsted)
+        return false;
+    if (node->hj_outExauhsted)
+        return true;
+
+    if (node->hj_InRead * HJ_SCHED_MIN_SHARE < node->hj_OutRead)
+        return true;
+    if (node->hj_OutRead * HJ_SCHED_MIN_SHARE < node->hj_InRead)
+        return false;
+
+    /* add one to each count so that a cold start alternates */
+    inrate = (node->hj_OutProbing + 1) / (node->hj_InRead + 1);
+    outrate = (node->hj_InProbing + 1) / (node->hj_OutRead + 1);
+
+    /* fetch times differ from run to run, and aren't checkpointed */
+    if (node->hj_CheckpointAt > 0)
+        return inrate >= outrate;
+
+    inrate /= (node->hj_InTime / (node->hj_InRead + 1)) + HJ_SCHED_MIN_COST;
+    outrate /= (node->hj_OutTime / (node->hj_OutRead + 1)) + HJ_SCHED_MIN_COST;
+
+    return inrate >= outrate;
+}
+
+/*
+ * ExecHashJoinFetch
+ *		get the next tuple of one input, timing the fetch for
+ *		ExecHashJoinChooseInput while there is still a choice to make
+ *
+ * A pair of gettimeofday calls can cost as much as fetching a tuple from a
+ * simple scan, so only every HJ_FETCH_TIMING_SAMPLE'th fetch of each input
+ * is timed, and counted that many times over.  The first fetch is always
+ * timed, so both inputs have an estimate from the start.
+ */
+#define HJ_FETCH_TIMING_SAMPLE	64
+
+static TupleTableSlot *
+ExecHashJoinFetch(HashJoinState *node, bool inner)
+{
+    PlanState  *child = inner ? innerPlanState(node) : outerPlanState(node);
+    TupleTableSlot *slot;
+    struct timeval starttime;
+    struct timeval endtime;
+    double      elapsed;
+
+    if (node->hj_inExauhsted || node->hj_outExauhsted ||
+        node->hj_CheckpointAt > 0)
+        return ExecProcNode(child);
+
+    if (fmod(inner ? node->hj_InRead : node->hj_OutRead,
+             HJ_FETCH_TIMING_SAMPLE) != 0)
+        return ExecProcNode(child);
+
+    gettimeofday(&starttime, NULL);
+    slot = ExecProcNode(child);
+    gettimeofday(&endtime, NULL);
+
+    elapsed = (double) (endtime.tv_sec - starttime.tv_sec) +
+        (double) (endtime.tv_usec - starttime.tv_usec) / 1000000.0;
+    elapsed *= HJ_FETCH_TIMING_SAMPLE;
+    if (inner)
+        node->hj_InTime += elapsed;
+    else
+        node->hj_OutTime += elapsed;
+
+    return slot;
+}
+
+/*
+ * Punctuation-driven purging.
+ *
+ * An input that returns its tuples in ascending join key order implicitly
+ * punctuates its stream: once it has returned key K, it will never return
+ * a key below K again, so any entry of the other table with a smaller key
+ * can never be matched and may be thrown away.  For ordered inputs that
+ * keeps the tables from holding the whole history of the join without
+ * needing a fixed window.
+ *
+ * Plan nodes have no way to send punctuation marks up the tree, so the
+ * order has to be guaranteed by the input itself: we recognize a Sort on
+ * the join key and a forward btree index scan on it, and only for a single
+ * mergejoinable join key.  Purging means a pass over the whole table, so
+ * it is done only when the table has doubled since the last purge (and
+ * has at least HJ_PURGE_MIN_SPACE bytes); that keeps the cost amortized
+ * constant per tuple.
+ */
+#define HJ_PURGE_MIN_SPACE	(64 * 1024L)
+
+/*
+ * ExecHashJoinInitPurge
+ *		set up purging for whichever inputs arrive in join key order
+ */
+static void
+ExecHashJoinInitPurge(HashJoinState *node)
+{
+    Oid         eqop;
+    Oid         leftsortop;
+    Oid         rightsortop;
+    Oid         ltop;
+    Oid         gtop;
+    RegProcedure ltproc;
+    RegProcedure gtproc;
+
+    /* a windowed table's ring still points at its tuples */
+    if (hashjoin_window_size > 0 ||
+        list_length(node->hj_HashOperators) != 1)
+        return;
+
+    eqop = linitial_oid(node->hj_HashOperators);
+    if (!op_mergejoinable(eqop, &leftsortop, &rightsortop))
+        return;
+    op_mergejoin_crossops(eqop, &ltop, &gtop, &ltproc, &gtproc);
+
+    /* an ordered inner input kills outer entries with outer key < its key */
+    if (ExecHashJoinInputOrdered((HashState *) innerPlanState(node),
+                                 rightsortop))
+    {
+        node->hj_InPurgeFn = (FmgrInfo *) palloc(sizeof(FmgrInfo));
+        fmgr_info(ltproc, node->hj_InPurgeFn);
+        node->hj_InPurgeAt = HJ_PURGE_MIN_SPACE;
+    }
+
+    /* an ordered outer input kills inner entries with its key > inner key */
+    if (ExecHashJoinInputOrdered((HashState *) outerPlanState(node),
+                                 leftsortop))
+    {
+        node->hj_OutPurgeFn = (FmgrInfo *) palloc(sizeof(FmgrInfo));
+        fmgr_info(gtproc, node->hj_OutPurgeFn);
+        node->hj_OutPurgeAt = HJ_PURGE_MIN_SPACE;
+    }
+}
+
+/*
+ * ExecHashJoinInputOrdered
+ *		true if the input below hashNode is sure to return its tuples in
+ *		ascending order of its join key, as sorted by sortop
+ *
+ * Both the Sort and the btree scan put nulls last, and ascending order can
+ * only be relied upon when the query runs forward.
+ */
+static bool
+ExecHashJoinInputOrdered(HashState *hashNode, Oid sortop)
+{
+    PlanState  *child = outerPlanState(hashNode);
+    Expr       *key;
+    AttrNumber  attno;
+
+    if (hashNode->ps.state->es_direction != ForwardScanDirection)
+        return false;
+
+    key = ((ExprState *) linitial(hashNode->hashkeys))->expr;
+    while (IsA(key, RelabelType))
+        key = ((RelabelType *) key)->arg;
+    if (!IsA(key, Var))
+        return false;
+    attno = ((Var *) key)->varattno;
+
+    if (IsA(child, SortState))
+    {
+        Sort       *sort = (Sort *) child->plan;
+
+        return (sort->sortColIdx[0] == attno &&
+                sort->sortOperators[0] == sortop);
+    }
+
+    if (IsA(child, IndexScanState))
+    {
+        IndexScan  *scan = (IndexScan *) child->plan;
+        Relation    index = ((IndexScanState *) child)->iss_RelationDesc;
+        TargetEntry *tle;
+
+        if (scan->indexorderdir != ForwardScanDirection ||
+            index->rd_rel->relam != BTREE_AM_OID)
+            return false;
+
+        /* the key must be the heap column the index leads with */
+        tle = get_tle_by_resno(child->plan->targetlist, attno);
+        if (tle == NULL || !IsA(tle->expr, Var) ||
+            ((Var *) tle->expr)->varattno != index->rd_index->indkey.values[0])
+            return false;
+
+        return (get_opclass_member(index->rd_indclass->values[0], InvalidOid,
+                                   BTLessStrategyNumber) == sortop);
+    }
+
+    return false;
+}
+
+/*
+ * ExecHashJoinPunctuate
+ *		purge the other table once the current tuple of an ordered input
+ *		has made enough of it dead
+ *
+ * The tuple is in econtext->ecxt_innertuple if inner, else in
+ * econtext->ecxt_outertuple.
+ */
+static void
+ExecHashJoinPunctuate(HashJoinState *node, bool inner)
+{
+    ExprContext *econtext = node->js.ps.ps_ExprContext;
+    HashJoinTable hashtable;
+    HashState  *hashNode;
+    ExprState  *keyexpr;
+    FmgrInfo   *purgefn;
+    Size       *purgeAt;
+    MemoryContext oldContext;
+    Datum       bound;
+    bool        isNull;
+
+    if (inner)
+    {
+        hashtable = node->hj_OutHashTable;
+        hashNode = (HashState *) outerPlanState(node);
+        keyexpr = (ExprState *) linitial(node->hj_InnerHashKeys);
+        purgefn = node->hj_InPurgeFn;
+        purgeAt = &node->hj_InPurgeAt;
+    }
+    else
+    {
+        hashtable = node->hj_InHashTable;
+        hashNode = (HashState *) innerPlanState(node);
+        keyexpr = (ExprState *) linitial(node->hj_OuterHashKeys);
+        purgefn = node->hj_OutPurgeFn;
+        purgeAt = &node->hj_OutPurgeAt;
+    }
+
+    if (hashtable->spaceUsed < *purgeAt)
+        return;
+
+    oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+    bound = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
+    MemoryContextSwitchTo(oldContext);
+
+    /* nulls come last; from here on the input can't match anything */
+    if (isNull)
+        return;
+
+    /* the outer table's keys are the comparison's left argument */
+    ExecHashTablePurge(hashtable, hashNode, purgefn, bound, !inner);
+
+    *purgeAt = Max(hashtable->spaceUsed * 2, HJ_PURGE_MIN_SPACE);
+}
+
+/*
+ * Persistent join state, by name; see HashJoinSavedState in
+ * executor/hashjoin.h.  The list and everything in it live in
+ * TopMemoryContext.
+ */
+static HashJoinSavedState *hj_saved_states = NULL;
+static bool hj_saved_callbacks = false;
+
+/*
+ * ExecHashJoinClaimState
+ *		find or create the persistent state named by hashjoin_state_name,
+ *		and mark it as in use by this join
+ *
+ * Returns NULL if another join of the running query already has the state;
+ * this join then runs without it.  A state left by a join of another shape
+ * is dropped and replaced.
+ */
+static HashJoinSavedState *
+ExecHashJoinClaimState(HashJoinState *node)
+{
+    HashJoinSavedState *state;
+    MemoryContext oldcxt;
+
+    if (!hj_saved_callbacks)
+    {
+        RegisterXactCallback(ExecHashJoinStateXactCallback, NULL);
+        RegisterSubXactCallback(ExecHashJoinStateSubXactCallback, NULL);
+        hj_saved_callbacks = true;
+    }
+
+    for (state = hj_saved_states; state != NULL; state = state->next)
+    {
+        if (strcmp(state->name, hashjoin_state_name) == 0)
+            break;
+    }
+
+    if (state != NULL)
+    {
+        if (state->inuse)
+            return NULL;
+        if (equal(state->hashoperators, node->hj_HashOperators) &&
+            ExecHashJoinSameRowType(state->outdesc,
+                                    ExecGetResultType(outerPlanState(node))) &&
+            ExecHashJoinSameRowType(state->indesc,
+                                    ExecGetResultType(innerPlanState(node))))
+        {
+            state->inuse = true;
+            state->changedSubid = GetCurrentSubTransactionId();
+            return state;
+        }
+        ExecHashJoinDropState(state);
+    }
+
+    oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+
+    state = (HashJoinSavedState *) palloc0(sizeof(HashJoinSavedState));
+    StrNCpy(state->name, hashjoin_state_name, NAMEDATALEN);
+    state->outdesc = CreateTupleDescCopy(ExecGetResultType(outerPlanState(node)));
+    state->indesc = CreateTupleDescCopy(ExecGetResultType(innerPlanState(node)));
+    state->hashoperators = list_copy(node->hj_HashOperators);
+    state->outtable = NULL;		/* the join creates them */
+    state->intable = NULL;
+    state->inuse = true;
+    state->changedSubid = GetCurrentSubTransactionId();
+    state->next = hj_saved_states;
+    hj_saved_states = state;
+
+    MemoryContextSwitchTo(oldcxt);
+
+    return state;
+}
+
+/*
+ * ExecHashJoinReleaseState
+ *		give up this join's claim on its persistent state, keeping the
+ *		tables for the next run if keep, else dropping the state
+ */
+static void
+ExecHashJoinReleaseState(HashJoinState *node, bool keep)
+{
+    HashJoinSavedState *state = node->hj_SavedState;
+
+    node->hj_SavedState = NULL;
+    if (keep)
+        state->inuse = false;
+    else
+        ExecHashJoinDropState(state);
+}
+
+/*
+ * ExecHashJoinSameRowType
+ *		can tuples of desc2 be stored alongside tuples of desc1?
+ */
+static bool
+ExecHashJoinSameRowType(TupleDesc desc1, TupleDesc desc2)
+{
+    int         i;
+
+    if (desc1->natts != desc2->natts)
+        return false;
+    for (i = 0; i < desc1->natts; i++)
+    {
+        if (desc1->attrs[i]->atttypid != desc2->attrs[i]->atttypid)
+            return false;
+    }
+    return true;
+}
+
+/*
+ * ExecHashJoinDropState
+ *		unlink a persistent state and free it, tables and all
+ */
+static void
+ExecHashJoinDropState(HashJoinSavedState *state)
+{
+    HashJoinSavedState **prev;
+
+    for (prev = &hj_saved_states; *prev != state; prev = &(*prev)->next)
+        Assert(*prev != NULL);
+    *prev = state->next;
+
+    if (state->outtable != NULL)
+        ExecHashTableDestroy(state->outtable);
+    if (state->intable != NULL)
+        ExecHashTableDestroy(state->intable);
+    FreeTupleDesc(state->outdesc);
+    FreeTupleDesc(state->indesc);
+    list_free(state->hashoperators);
+    pfree(state);
+}
+
+/*
+ * At commit, states changed by the transaction become permanent; at abort
+ * they are dropped, as their tables hold rows the aborted queries added.
+ * A state still in use at commit belongs to a join that was never shut
+ * down, so it is dropped as well.
+ */
+static void
+ExecHashJoinStateXactCallback(XactEvent event, void *arg)
+{
+    HashJoinSavedState *state;
+    HashJoinSavedState *next;
+
+    for (state = hj_saved_states; state != NULL; state = next)
+    {
+        next = state->next;
+        if (state->changedSubid == InvalidSubTransactionId)
+            continue;
+        if (event == XACT_EVENT_ABORT || state->inuse)
+            ExecHashJoinDropState(state);
+        else
+            state->changedSubid = InvalidSubTransactionId;
+    }
+}
+
+static void
+ExecHashJoinStateSubXactCallback(SubXactEvent event,
+                                 SubTransactionId mySubid,
+                                 SubTransactionId parentSubid,
+                                 void *arg)
+{
+    HashJoinSavedState *state;
+    HashJoinSavedState *next;
+
+    for (state = hj_saved_states; state != NULL; state = next)
+    {
+        next = state->next;
+        if (state->changedSubid != mySubid)
+            continue;
+        if (event == SUBXACT_EVENT_ABORT_SUB)
+            ExecHashJoinDropState(state);
+        else if (event == SUBXACT_EVENT_COMMIT_SUB)
+            state->changedSubid = parentSubid;
+    }
+}
+
+/*
+ * Checkpoints.
+ *
+ * Under hashjoin_checkpoint_file, a hash join writes its whole state to
+ * that file after every hashjoin_checkpoint_interval input rows, so that a
+ * join that is canceled, or whose backend goes away, can later be resumed
+ * instead of starting over.  A checkpoint is only taken between input
+ * tuples, when every join row the tuples read so far can produce has been
+ * returned.  It consists of a header, then the outer and the inner table's
+ * tuples in the batch file record format (HashJoinSpillRecord, then the
+ * tuple data, each padded to MAXALIGN), each list ending with a record of
+ * zero length.  The header is written field by field, starting with
+ * HJ_CHECKPOINT_MAGIC and HJ_CHECKPOINT_VERSION, so its layout doesn't
+ * depend on the compiler's padding.  The file is written under a temporary
+ * name and renamed into place, so there is always one complete checkpoint.
+ *
+ * A plan node can't save its scan position, let alone restore it in
+ * another backend, so each input's position is recorded as the number of
+ * rows consumed from it, and on resume that many rows are read and thrown
+ * away.  This is only right if the inputs return the same rows in the same
+ * order as before, i.e. the same plan over unchanged data.
+ *
+ * The resumed run must also produce its join rows in the same order as the
+ * interrupted one did after the checkpoint, or holding back a count of
+ * rows (below) would drop some and repeat others.  So a checkpointed join
+ * reads its inputs in an order that depends on nothing but the rows: it
+ * schedules them by counts alone, leaving out the fetch times (see
+ * ExecHashJoinChooseInput), and its tables are checkpointed so that
+ * reloading them rebuilds every bucket chain in the same order.
+ *
+ * The rows the interrupted run returned after its last checkpoint come out
+ * of the resumed run again, and must not be returned twice.  So the join
+ * also keeps the number of rows it has returned in the checkpoint file's
+ * header, at HJ_CHECKPOINT_POS_OFFSET, through a shared mapping of the file
+ * that it updates with a plain store per row; that survives the backend,
+ * though not necessarily a crash of the operating system.  The resumed run
+ * holds back that many rows.  Only one join per backend can own the file;
+ * another join of the same query runs without checkpoints.  The file is
+ * removed once the join has read both inputs to the end.
+ *
+ * Batch files don't outlive the query, so only the owner's tables are kept
+ * in a single batch, and only while they fit in work_mem.  When they
+ * outgrow it, the join removes its checkpoint file and goes on batching
+ * like any other (see ExecHashJoinCheckpointIfDue).
+ */
+#define HJ_CHECKPOINT_MAGIC		0x48434a31	/* "HCJ1" */
+#define HJ_CHECKPOINT_VERSION	1
+
+/* rowsEmitted comes right after magic and version */
+#define HJ_CHECKPOINT_POS_OFFSET	(2 * sizeof(uint32))
+
+typedef struct HashJoinCheckpointHeader
+{
+    uint32      magic;
+    uint32      version;
+    double      rowsEmitted;	/* # join rows returned, kept up to date */
+    uint32      signature;		/* see ExecHashJoinSignature */
+    bool        inFetched;		/* scheduling state, as in HashJoinState */
+    bool        inExhausted;
+    bool        outExhausted;
+    int32       inProbing;
+    int32       outProbing;
+    double      inRead;			/* rows read from each input ... */
+    double      outRead;
+    double      inFiltered;		/* ... and dropped by the runtime filter */
+    double      outFiltered;
+    double      rowsReturned;	/* # join rows as of the checkpoint */
+} HashJoinCheckpointHeader;
+
+/* the join that owns the checkpoint file, and its mapped rowsEmitted */
+static HashJoinState *hj_checkpoint_owner = NULL;
+static double *hj_checkpoint_pos = NULL;
+static bool hj_checkpoint_callback = false;
+
+/*
+ * ExecHashJoinSignature
+ *		hash of the join operators and input row types, so that a join
+ *		doesn't resume from another one's checkpoint
+ */
+static uint32
+ExecHashJoinSignature(HashJoinState *node)
+{
+    TupleDesc   outdesc = ExecGetResultType(outerPlanState(node));
+    TupleDesc   indesc = ExecGetResultType(innerPlanState(node));
+    Oid        *oids;
+    int         n = 0;
+    int         i;
+    ListCell   *l;
+    uint32      signature;
+
+    oids = (Oid *) palloc((list_length(node->hj_HashOperators) +
+                           outdesc->natts + indesc->natts + 2) * sizeof(Oid));
+    foreach(l, node->hj_HashOperators)
+        oids[n++] = lfirst_oid(l);
+    oids[n++] = InvalidOid;
+    for (i = 0; i < outdesc->natts; i++)
+        oids[n++] = outdesc->attrs[i]->atttypid;
+    oids[n++] = InvalidOid;
+    for (i = 0; i < indesc->natts; i++)
+        oids[n++] = indesc->attrs[i]->atttypid;
+
+    signature = DatumGetUInt32(hash_any((unsigned char *) oids,
+                                        n * sizeof(Oid)));
+    pfree(oids);
+
+    return signature;
+}
+
+/*
+ * ExecHashJoinClaimCheckpoint
+ *		make this join the owner of the checkpoint file
+ *
+ * Returns false if another join of the running query already owns it;
+ * this join then runs without checkpoints.  The file name must be an
+ * absolute path, as for COPY to a file.
+ */
+static bool
+ExecHashJoinClaimCheckpoint(HashJoinState *node)
+{
+    if (!is_absolute_path(hashjoin_checkpoint_file))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_NAME),
+                 errmsg("relative path not allowed for hash join checkpoint file")));
+
+    if (!hj_checkpoint_callback)
+    {
+        RegisterXactCallback(ExecHashJoinCheckpointXactCallback, NULL);
+        hj_checkpoint_callback = true;
+    }
+
+    if (hj_checkpoint_owner != NULL)
+        return false;
+    hj_checkpoint_owner = node;
+    node->hj_CheckpointFile = pstrdup(hashjoin_checkpoint_file);
+    return true;
+}
+
+/*
+ * ExecHashJoinReleaseCheckpoint
+ *		stop checkpointing, and let another join own the file
+ *
+ * The file stays, so that a later run can resume from it, unless remove.
+ */
+static void
+ExecHashJoinReleaseCheckpoint(HashJoinState *node, bool remove)
+{
+    if (hj_checkpoint_owner != node)
+        return;
+
+    ExecHashJoinUnmapPosition();
+    if (remove &&
+        unlink(node->hj_CheckpointFile) < 0 && errno != ENOENT)
+        ereport(WARNING,
+                (errcode_for_file_access(),
+                 errmsg("could not remove hash join checkpoint file \"%s\": %m",
+                        node->hj_CheckpointFile)));
+    node->hj_CheckpointAt = 0;
+    hj_checkpoint_owner = NULL;
+}
+
+/*
+ * At the end of a transaction, any join still owning the checkpoint file
+ * was never shut down, i.e. its query failed.
+ */
+static void
+ExecHashJoinCheckpointXactCallback(XactEvent event, void *arg)
+{
+    ExecHashJoinUnmapPosition();
+    hj_checkpoint_owner = NULL;
+}
+
+/*
+ * ExecHashJoinMapPosition
+ *		map rowsEmitted of the checkpoint file, so that ExecHashJoinEmitRow
+ *		can keep it up to date without a system call per row
+ */
+static void
+ExecHashJoinMapPosition(HashJoinState *node)
+{
+    int         fd;
+    char       *base;
+    int         save_errno;
+
+    ExecHashJoinUnmapPosition();
+
+    fd = BasicOpenFile(node->hj_CheckpointFile, O_RDWR | PG_BINARY, 0);
+    if (fd < 0)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not open hash join checkpoint file \"%s\": %m",
+                        node->hj_CheckpointFile)));
+    base = mmap(NULL, HJ_CHECKPOINT_POS_OFFSET + sizeof(double),
+                PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    save_errno = errno;
+    close(fd);
+    errno = save_errno;
+    if (base == MAP_FAILED)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not map hash join checkpoint file \"%s\": %m",
+                        node->hj_CheckpointFile)));
+
+    hj_checkpoint_pos = (double *) (base + HJ_CHECKPOINT_POS_OFFSET);
+}
+
+static void
+ExecHashJoinUnmapPosition(void)
+{
+    if (hj_checkpoint_pos == NULL)
+        return;
+    munmap((char *) hj_checkpoint_pos - HJ_CHECKPOINT_POS_OFFSET,
+           HJ_CHECKPOINT_POS_OFFSET + sizeof(double));
+    hj_checkpoint_pos = NULL;
+}
+
+/*
+ * ExecHashJoinEmitRow
+ *		count a join row of the first pass that is about to be returned
+ *
+ * Returns false if the row must be held back instead, because the
+ * interrupted run this one resumes has returned it already.
+ */
+static bool
+ExecHashJoinEmitRow(HashJoinState *node)
+{
+    node->hj_RowsReturned += 1;
+    if (node->hj_RowsReturned <= node->hj_RowsResumed)
+        return false;
+    if (hj_checkpoint_pos != NULL && hj_checkpoint_owner == node)
+        *hj_checkpoint_pos = node->hj_RowsReturned;
+    return true;
+}
+
+/*
+ * ExecHashJoinCheckpointHeaderIO
+ *		write (if writing) or read the header of a checkpoint file, one
+ *		field at a time
+ */
+static void
+ExecHashJoinCheckpointHeaderIO(FILE *file, const char *path,
+                               HashJoinCheckpointHeader *hdr, bool writing)
+{
+    char        flags[3];
+
+#define HJ_CHECKPOINT_FIELD(field) \
+    do { \
+        if (writing) \
+            ExecHashJoinCheckpointWrite(file, path, &(field), sizeof(field)); \
+        else \
+            ExecHashJoinResumeRead(file, path, &(field), sizeof(field)); \
+    } while (0)
+
+    flags[0] = hdr->inFetched;
+    flags[1] = hdr->inExhausted;
+    flags[2] = hdr->outExhausted;
+
+    HJ_CHECKPOINT_FIELD(hdr->magic);
+    HJ_CHECKPOINT_FIELD(hdr->version);
+    if (!writing &&
+        (hdr->magic != HJ_CHECKPOINT_MAGIC ||
+         hdr->version != HJ_CHECKPOINT_VERSION))
+        ereport(ERROR,
+                (errmsg("\"%s\" is not a hash join checkpoint file of version %d",
+                        path, HJ_CHECKPOINT_VERSION)));
+    HJ_CHECKPOINT_FIELD(hdr->rowsEmitted);
+    HJ_CHECKPOINT_FIELD(hdr->signature);
+    HJ_CHECKPOINT_FIELD(flags);
+    HJ_CHECKPOINT_FIELD(hdr->inProbing);
+    HJ_CHECKPOINT_FIELD(hdr->outProbing);
+    HJ_CHECKPOINT_FIELD(hdr->inRead);
+    HJ_CHECKPOINT_FIELD(hdr->outRead);
+    HJ_CHECKPOINT_FIELD(hdr->inFiltered);
+    HJ_CHECKPOINT_FIELD(hdr->outFiltered);
+    HJ_CHECKPOINT_FIELD(hdr->rowsReturned);
+
+#undef HJ_CHECKPOINT_FIELD
+
+    hdr->inFetched = (flags[0] != 0);
+    hdr->inExhausted = (flags[1] != 0);
+    hdr->outExhausted = (flags[2] != 0);
+}
+
+/*
+ * ExecHashJoinCheckpointIfDue
+ *		checkpoint the join if hashjoin_checkpoint_interval input rows have
+ *		been read since the last checkpoint
+ *
+ * A checkpointed join's tables can't spill, so once they outgrow work_mem,
+ * they stop being checkpointed (see ExecHashIncreaseNumBatches), and the
+ * join gives up its checkpoint file instead of its memory limit.
+ */
+static void
+ExecHashJoinCheckpointIfDue(HashJoinState *node)
+{
+    if (!node->hj_OutHashTable->checkpointed)
+    {
+        ereport(NOTICE,
+                (errmsg("hash join stopped checkpointing because its hash tables exceed work_mem"),
+                 errhint("Raise work_mem to checkpoint this join.")));
+        ExecHashJoinReleaseCheckpoint(node, true);
+    }
+    else if (node->hj_InRead + node->hj_OutRead >= node->hj_CheckpointAt)
+        ExecHashJoinCheckpoint(node);
+}
+
+/*
+ * ExecHashJoinCheckpoint
+ *		write the join's state to its checkpoint file
+ */
+static void
+ExecHashJoinCheckpoint(HashJoinState *node)
+{
+    char        tmppath[MAXPGPATH];
+    FILE       *file;
+    HashJoinCheckpointHeader hdr;
+
+    snprintf(tmppath, sizeof(tmppath), "%s.tmp", node->hj_CheckpointFile);
+    file = AllocateFile(tmppath, PG_BINARY_W);
+    if (file == NULL)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not create hash join checkpoint file \"%s\": %m",
+                        tmppath)));
+
+    hdr.magic = HJ_CHECKPOINT_MAGIC;
+    hdr.version = HJ_CHECKPOINT_VERSION;
+    hdr.rowsEmitted = Max(node->hj_RowsReturned, node->hj_RowsResumed);
+    hdr.signature = ExecHashJoinSignature(node);
+    hdr.inFetched = node->hj_InFetched;
+    hdr.inExhausted = node->hj_inExauhsted;
+    hdr.outExhausted = node->hj_outExauhsted;
+    hdr.inProbing = node->hj_InProbing;
+    hdr.outProbing = node->hj_OutProbing;
+    hdr.inRead = node->hj_InRead;
+    hdr.outRead = node->hj_OutRead;
+    hdr.inFiltered = ((HashState *) innerPlanState(node))->nfiltered;
+    hdr.outFiltered = ((HashState *) outerPlanState(node))->nfiltered;
+    hdr.rowsReturned = node->hj_RowsReturned;
+
+    ExecHashJoinCheckpointHeaderIO(file, tmppath, &hdr, true);
+    ExecHashJoinCheckpointTable(file, tmppath, node->hj_OutHashTable);
+    ExecHashJoinCheckpointTable(file, tmppath, node->hj_InHashTable);
+
+    if (fflush(file) != 0 || pg_fsync(fileno(file)) != 0)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not write hash join checkpoint file \"%s\": %m",
+                        tmppath)));
+    if (FreeFile(file))
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not write hash join checkpoint file \"%s\": %m",
+                        tmppath)));
+
+    if (rename(tmppath, node->hj_CheckpointFile) < 0)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not rename file \"%s\" to \"%s\": %m",
+                        tmppath, node->hj_CheckpointFile)));
+
+    /* from now on, count returned rows in the new file */
+    ExecHashJoinMapPosition(node);
+
+    node->hj_CheckpointAt = node->hj_InRead + node->hj_OutRead +
+        Max(hashjoin_checkpoint_interval, 1);
+}
+
+/*
+ * ExecHashJoinCheckpointTable
+ *		write all the tuples of a hash table, and the end marker
+ *
+ * A windowed table is written oldest tuple first, so that reloading it
+ * rebuilds the same window.
+ */
+static void
+ExecHashJoinCheckpointTable(FILE *file, const char *path,
+                            HashJoinTable hashtable)
+{
+    HashJoinTuple hashTuple;
+    HashJoinTuple tuple;
+    HeapTupleData endmarker;
+    long        i;
+
+    if (hashtable->windowSize > 0)
+    {
+        for (i = 0; i < hashtable->windowSize; i++)
+        {
+            hashTuple = hashtable->windowRing[(hashtable->windowNext + i) %
+                                              hashtable->windowSize];
+            if (hashTuple != NULL)
+                ExecHashJoinCheckpointTuple(file, path, &hashTuple->htup,
+                                            hashTuple->hashvalue);
+        }
+    }
+    else
+    {
+        /* the main buckets, then the skew buckets */
+        for (i = 0; i < hashtable->nbuckets + hashtable->skewBucketLen; i++)
+        {
+            if (i < hashtable->nbuckets)
+                hashTuple = hashtable->buckets[i];
+            else if (hashtable->skewBucket[i - hashtable->nbuckets] != NULL)
+                hashTuple = hashtable->skewBucket[i - hashtable->nbuckets]->tuples;
+            else
+                continue;
+
+            /*
+             * Reloading prepends each tuple to its chain, so write the chain
+             * from its tail: reverse it, write it, and reverse it back.
+             */
+            hashTuple = ExecHashJoinReverseChain(hashTuple);
+            for (tuple = hashTuple; tuple != NULL; tuple = tuple->next)
+                ExecHashJoinCheckpointTuple(file, path, &tuple->htup,
+                                            tuple->hashvalue);
+            hashTuple = ExecHashJoinReverseChain(hashTuple);
+            if (i < hashtable->nbuckets)
+                hashtable->buckets[i] = hashTuple;
+            else
+                hashtable->skewBucket[i - hashtable->nbuckets]->tuples = hashTuple;
+        }
+    }
+
+    MemSet(&endmarker, 0, sizeof(endmarker));
+    ExecHashJoinCheckpointTuple(file, path, &endmarker, 0);
+}
+
+/*
+ * ExecHashJoinReverseChain
+ *		reverse a bucket chain in place, returning its new head
+ */
+static HashJoinTuple
+ExecHashJoinReverseChain(HashJoinTuple hashTuple)
+{
+    HashJoinTuple reversed = NULL;
+
+    while (hashTuple != NULL)
+    {
+        HashJoinTuple next = hashTuple->next;
+
+        hashTuple->next = reversed;
+        reversed = hashTuple;
+        hashTuple = next;
+    }
+    return reversed;
+}
+
+/*
+ * ExecHashJoinCheckpointTuple
+ *		write one tuple as a batch file record
+ */
+static void
+ExecHashJoinCheckpointTuple(FILE *file, const char *path,
+                            HeapTuple tuple, uint32 hashvalue)
+{
+    char        rec[MAXALIGN(sizeof(HashJoinSpillRecord))];
+    char        padding[MAXIMUM_ALIGNOF];
+    HashJoinSpillRecord *hdr = (HashJoinSpillRecord *) rec;
+
+    /* zero the header, so that its padding doesn't go out uninitialized */
+    MemSet(rec, 0, sizeof(rec));
+    hdr->hashvalue = hashvalue;
+    hdr->t_len = tuple->t_len;
+    hdr->t_self = tuple->t_self;
+    hdr->t_tableOid = tuple->t_tableOid;
+    ExecHashJoinCheckpointWrite(file, path, rec, sizeof(rec));
+    if (tuple->t_len == 0)
+        return;
+
+    MemSet(padding, 0, sizeof(padding));
+    ExecHashJoinCheckpointWrite(file, path, tuple->t_data, tuple->t_len);
+    ExecHashJoinCheckpointWrite(file, path, padding,
+                                MAXALIGN(tuple->t_len) - tuple->t_len);
+}
+
+static void
+ExecHashJoinCheckpointWrite(FILE *file, const char *path,
+                            void *data, size_t len)
+{
+    if (fwrite(data, 1, len, file) != len)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not write hash join checkpoint file \"%s\": %m",
+                        path)));
+}
+
+/*
+ * ExecHashJoinResume
+ *		restore the join's state from its checkpoint file, if there is one
+ *
+ * Called with both hash tables freshly created and empty.
+ */
+static void
+ExecHashJoinResume(HashJoinState *node)
+{
+    const char *path = node->hj_CheckpointFile;
+    HashState  *outHashNode = (HashState *) outerPlanState(node);
+    HashState  *inHashNode = (HashState *) innerPlanState(node);
+    HashJoinCheckpointHeader hdr;
+    FILE       *file;
+
+    file = AllocateFile(path, PG_BINARY_R);
+    if (file == NULL)
+    {
+        if (errno == ENOENT)
+            return;				/* nothing to resume; start from scratch */
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not open hash join checkpoint file \"%s\": %m",
+                        path)));
+    }
+
+    ExecHashJoinCheckpointHeaderIO(file, path, &hdr, false);
+    if (hdr.signature != ExecHashJoinSignature(node))
+        ereport(ERROR,
+                (errmsg("hash join checkpoint file \"%s\" was written by a different join",
+                        path),
+                 errhint("Remove the file, or set hashjoin_checkpoint_file to another file.")));
+
+    ExecHashJoinResumeTable(file, path, node->hj_OutHashTable);
+    ExecHashJoinResumeTable(file, path, node->hj_InHashTable);
+    FreeFile(file);
+
+    node->hj_InFetched = hdr.inFetched;
+    node->hj_inExauhsted = hdr.inExhausted;
+    node->hj_outExauhsted = hdr.outExhausted;
+    node->hj_InProbing = hdr.inProbing;
+    node->hj_OutProbing = hdr.outProbing;
+    node->hj_InRead = hdr.inRead;
+    node->hj_OutRead = hdr.outRead;
+    inHashNode->nfiltered = hdr.inFiltered;
+    outHashNode->nfiltered = hdr.outFiltered;
+
+    /*
+     * The rows returned after the checkpoint will be produced again; hold
+     * them back, and go on counting in the same file.
+     */
+    node->hj_RowsReturned = hdr.rowsReturned;
+    node->hj_RowsResumed = hdr.rowsEmitted;
+    ExecHashJoinMapPosition(node);
+
+    /* an exhausted input's table was filtering the other input */
+    if (hdr.inExhausted && node->js.jointype != JOIN_LEFT)
+        outHashNode->filtertable = node->hj_InHashTable;
+    if (hdr.outExhausted)
+        inHashNode->filtertable = node->hj_OutHashTable;
+
+    /* move each input past the rows the interrupted run consumed */
+    if (!hdr.inExhausted)
+        ExecHashJoinSkipRows(inHashNode, hdr.inRead + hdr.inFiltered);
+    if (!hdr.outExhausted)
+        ExecHashJoinSkipRows(outHashNode, hdr.outRead + hdr.outFiltered);
+}
+
+/*
+ * ExecHashJoinResumeTable
+ *		load the tuples of one hash table from a checkpoint file
+ */
+static void
+ExecHashJoinResumeTable(FILE *file, const char *path,
+                        HashJoinTable hashtable)
+{
+    for (;;)
+    {
+        char        rec[MAXALIGN(sizeof(HashJoinSpillRecord))];
+        HashJoinSpillRecord *hdr = (HashJoinSpillRecord *) rec;
+        HeapTuple   heapTuple;
+
+        ExecHashJoinResumeRead(file, path, rec, sizeof(rec));
+        if (hdr->t_len == 0)
+            break;				/* end marker */
+
+        heapTuple = palloc(HEAPTUPLESIZE + MAXALIGN(hdr->t_len));
+        heapTuple->t_len = hdr->t_len;
+        heapTuple->t_self = hdr->t_self;
+        heapTuple->t_tableOid = hdr->t_tableOid;
+        heapTuple->t_datamcxt = CurrentMemoryContext;
+        heapTuple->t_data = (HeapTupleHeader)
+            ((char *) heapTuple + HEAPTUPLESIZE);
+        ExecHashJoinResumeRead(file, path, heapTuple->t_data,
+                               MAXALIGN(hdr->t_len));
+
+        ExecHashTableInsert(hashtable, heapTuple, hdr->hashvalue);
+        hashtable->totalTuples += 1;
+        pfree(heapTuple);
+
+        /* the state must fit in memory to be checkpointed again */
+        if (!hashtable->checkpointed)
+            ereport(ERROR,
+                    (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+                     errmsg("hash join checkpoint file \"%s\" does not fit in work_mem",
+                            path),
+                     errhint("Raise work_mem, or remove the file to start the join over.")));
+    }
+}
+
+static void
+ExecHashJoinResumeRead(FILE *file, const char *path, void *data, size_t len)
+{
+    if (fread(data, 1, len, file) != len)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not read hash join checkpoint file \"%s\": %m",
+                        path)));
+}
+
+/*
+ * ExecHashJoinSkipRows
+ *		read and discard rows from the input below a Hash node
+ *
+ * The rows bypass the Hash node, so they go into neither table.
+ */
+static void
+ExecHashJoinSkipRows(HashState *hashNode, double nrows)
+{
+    PlanState  *child = outerPlanState(hashNode);
+
+    for (; nrows > 0; nrows -= 1)
+    {
+        if (TupIsNull(ExecProcNode(child)))
+            ereport(ERROR,
+                    (errmsg("hash join input has fewer rows than its checkpoint says were read")));
+    }
+}
+
+/*
+ * ExecHashJoinReportStats
+ *
+ *		report per-table statistics of a hash join at the end of an
+ *		EXPLAIN ANALYZE run
+ *
+ * EXPLAIN prints only the generic per-node instrumentation, so the hash
+ * join reports its own counters at DEBUG1, one line per table.  Set
+ * client_min_messages to debug1 to see them next to the plan.
+ */
+static void
+ExecHashJoinReportStats(HashJoinState *node)
+{
+    int         side;
+
+    if (node->hj_SavedState != NULL)
+        ereport(DEBUG1,
+                (errmsg("hash join state \"%s\": %.0f outer and %.0f inner rows kept",
+                        node->hj_SavedState->name,
+                        node->hj_OutHashTable ? node->hj_OutHashTable->totalTuples : 0,
+                        node->hj_InHashTable ? node->hj_InHashTable->totalTuples : 0)));
+
+    for (side = 0; side < 2; side++)
+    {
+        HashJoinTable hashtable;
+        HashState  *hashNode;
+        const char *name;
+
+        hashtable = side ? node->hj_InHashTable : node->hj_OutHashTable;
+        hashNode = (HashState *) (side ? innerPlanState(node) : outerPlanState(node));
+        name = side ? "inner" : "outer";
+        if (hashtable == NULL)
+            continue;
+
+        ereport(DEBUG1,
+                (errmsg("hash join %s table: Bloom filter %u kB, %.0f probes passed, %.0f rejected",
+                        name,
+                        (unsigned int) (hashtable->nbloomBlocks *
+                                        HJ_BLOOM_BLOCK_WORDS * sizeof(uint32) / 1024),
+                        hashtable->bloomPassed,
+                        hashtable->bloomRejected)));
+        ereport(DEBUG1,
+                (errmsg("hash join %s input: %.0f rows read, %d join rows produced by its probes",
+                        name,
+                        side ? node->hj_InRead : node->hj_OutRead,
+                        side ? node->hj_OutProbing : node->hj_InProbing)));
+        ereport(DEBUG1,
+                (errmsg("hash join %s input: about %.3f s spent waiting for rows while both inputs were read",
+                        name,
+                        side ? node->hj_InTime : node->hj_OutTime)));
+        if (hashtable->windowSize > 0)
+            ereport(DEBUG1,
+                    (errmsg("hash join %s table: window of %d tuples, %.0f evicted",
+                            name, hashtable->windowSize,
+                            hashtable->windowEvicted)));
+        if (hashtable->nSkewBuckets > 0)
+            ereport(DEBUG1,
+                    (errmsg("hash join %s table: %d skew buckets hold %.0f tuples",
+                            name, hashtable->nSkewBuckets,
+                            hashtable->skewTuples)));
+        if (hashtable->purgedTuples > 0)
+            ereport(DEBUG1,
+                    (errmsg("hash join %s table: %.0f tuples purged behind the ordered %s input",
+                            name, hashtable->purgedTuples,
+                            side ? "outer" : "inner")));
+        if (hashtable->spillStats.blocksWritten > 0)
+            ereport(DEBUG1,
+                    (errmsg("hash join %s table: %.0f kB spilled in %.0f blocks (%.3f s writing), %.0f kB read back (%.3f s reading)",
+                            name,
+                            hashtable->spillStats.bytesWritten / 1024,
+                            hashtable->spillStats.blocksWritten,
+                            hashtable->spillStats.writeTime,
+                            hashtable->spillStats.bytesRead / 1024,
+                            hashtable->spillStats.readTime)));
+        if (hashtable->arena != NULL)
+            ereport(DEBUG1,
+                    (errmsg("hash join %s table: %lu kB memory-mapped, at most %lu kB of it used, %lu kB allocated outside it",
+                            name,
+                            (unsigned long) (hashtable->arena->size / 1024),
+                            (unsigned long) (hashtable->arena->peak / 1024),
+                            (unsigned long) (hashtable->arena->overflow / 1024))));
+        if (hashjoin_huge_pages)
+            ereport(DEBUG1,
+                    (errmsg("hash join %s table: huge pages %s for buckets, %s for tuples",
+                            name,
+                            ((hashtable->bucketArena != NULL &&
+                              hashtable->bucketArena->hugePages) ||
+                             (hashtable->arena != NULL &&
+                              hashtable->arena->hugePages)) ? "used" : "not used",
+                            (hashtable->arena != NULL &&
+                             hashtable->arena->hugePages) ? "used" : "not used")));
+        if (hashtable->batchesFlushed > 0 || hashtable->flushedSpace > 0)
+            ereport(DEBUG1,
+                    (errmsg("hash join %s table: %d batches chosen for flushing, %.0f kB of tuples flushed",
+                            name, hashtable->batchesFlushed,
+                            hashtable->flushedSpace / 1024)));
+        if (hashNode->nfiltered > 0)
+            ereport(DEBUG1,
+                    (errmsg("hash join %s input: %.0f rows removed by runtime join filter",
+                            name, hashNode->nfiltered)));
+    }
+
+    if (node->hj_InHashTable != NULL && node->hj_InHashTable->nbatch > 1)
+        ereport(DEBUG1,
+                (errmsg("hash join: %d batches, %d joined after both inputs ended, in %d extra chunks",
+                        node->hj_InHashTable->nbatch, node->hj_BatchesJoined,
+                        node->hj_ExtraChunks)));
+}
+
+/*
+ * ExecHashJoinBatches
+ *		join the batches that were spilled to temp files
+ *
+ * Called once both inputs have ended.  Batches are taken one at a time,
+ * largest first (see ExecHashJoinNewBatch): one side's tuples of the batch
+ * have been loaded into its table, and we stream the other side's saved
+ * tuples past them.  hj_InFetched tells which side streams, exactly as in
+ * the first pass, and hj_BatchFileNo which of its two files we're reading:
+ * 0 for its unjoinedBatchFile (tuples not joined with anything yet) and 1
+ * for its joinedBatchFile (tuples joined with the first pass's tuples
+ * already).
+ * hj_ProbeJoined says which it is, so that ExecScanHashBucket can skip
+ * pairs the first pass has produced.
+ *
+ * Returns the next join tuple, or NULL once all batches have been joined.
+ */
+static TupleTableSlot *
+ExecHashJoinBatches(HashJoinState *node)
+{
+    EState     *estate = node->js.ps.state;
+    List       *joinqual = node->js.joinqual;
+    List       *otherqual = node->js.ps.qual;
+    ExprContext *econtext = node->js.ps.ps_ExprContext;
+    HashJoinTable inhashtable = node->hj_InHashTable;
+    HashJoinTable outhashtable = node->hj_OutHashTable;
+    ExprDoneCond isDone;
+
+    /* the first pass leaves curbatch at 0 */
+    if (inhashtable->curbatch == 0)
+    {
+        ExecHashTableEndFirstPass(inhashtable);
+        ExecHashTableEndFirstPass(outhashtable);
+        if (!ExecHashJoinNewBatch(node))
+            return NULL;
+    }
+
+    for (;;)
+    {
+        HashJoinTable streamtable;
+        HashJoinTable buildtable;
+        TupleTableSlot *slot;
+        TupleTableSlot *readslot;
+        HashJoinBatchFile *files;
+        uint32      hashvalue;
+        int         curbatch;
+        long        bucketno;
+        int         batchno;
+
+        if (node->hj_InFetched)
+        {
+            streamtable = inhashtable;
+            buildtable = outhashtable;
+            slot = node->js.ps.ps_InnerTupleSlot;
+        }
+        else
+        {
+            streamtable = outhashtable;
+            buildtable = inhashtable;
+            slot = node->js.ps.ps_OuterTupleSlot;
+        }
+        curbatch = streamtable->curbatch;
+
+        /*
+         * emit the remaining matches of the current stream tuple
+         */
+        if (!TupIsNull(slot))
+        {
+            for (;;)
+            {
+                HeapTuple   curtuple;
+                TupleTableSlot *streamslot;
+
+                if (node->hj_InFetched)
+                    econtext->ecxt_innertuple = slot;
+                else
+                    econtext->ecxt_outertuple = slot;
+                curtuple = ExecScanHashBucket(node, econtext);
+                if (curtuple == NULL)
+                    break;
+
+                /*
+                 * The stream tuple's key columns sufficed to find the match;
+                 * the rest of the quals and the projection need all of it.
+                 */
+                if (streamtable->lateRel != NULL)
+                {
+                    streamslot = node->hj_InFetched ? node->hj_InTupleSlot :
+                        node->hj_OuterTupleSlot;
+                    if (!node->hj_ProbeFetched)
+                    {
+                        (void) ExecHashStoreMatch(streamtable,
+                                                  ExecFetchSlotTuple(slot),
+                                                  streamslot, estate);
+                        node->hj_ProbeFetched = true;
+                    }
+                }
+                else
+                    streamslot = slot;
+
+                if (node->hj_InFetched)
+                {
+                    econtext->ecxt_innertuple = streamslot;
+                    econtext->ecxt_outertuple =
+                        ExecHashStoreMatch(buildtable, curtuple,
+                                           node->hj_OuterTupleSlot, estate);
+                }
+                else
+                {
+                    econtext->ecxt_outertuple = streamslot;
+                    econtext->ecxt_innertuple =
+                        ExecHashStoreMatch(buildtable, curtuple,
+                                           node->hj_InTupleSlot, estate);
+                }
+                ResetExprContext(econtext);
+
+                if (joinqual == NIL || ExecQual(joinqual, econtext, false)) {
+                    if (otherqual == NIL || ExecQual(otherqual, econtext, false)) {
+                        TupleTableSlot *result;
+
+                        result = ExecProject(node->js.ps.ps_ProjInfo, &isDone);
+                        if (isDone != ExprEndResult) {
+                            if (node->hj_InFetched)
+                                node->hj_OutProbing = node->hj_OutProbing + 1;
+                            else
+                                node->hj_InProbing = node->hj_InProbing + 1;
+                            node->js.ps.ps_TupFromTlist = (isDone == ExprMultipleResult);
+                            return result;
+                        }
+                    }
+                }
+            }
+            if (node->hj_InFetched)
+                node->js.ps.ps_InnerTupleSlot = NULL;
+            else
+                node->js.ps.ps_OuterTupleSlot = NULL;
+        }
+
+        /*
+         * read the next stream tuple.  Under late materialization the file
+         * holds only its key columns, which is all the probe needs; the
+         * rest is refetched only once it has found a match.
+         */
+        if (streamtable->lateRel != NULL)
+            readslot = node->hj_InFetched ? node->hj_InHashTupleSlot :
+                node->hj_OutHashTupleSlot;
+        else
+            readslot = node->hj_InFetched ? node->hj_InTupleSlot :
+                node->hj_OuterTupleSlot;
+
+        slot = NULL;
+        while (node->hj_BatchFileNo < 2)
+        {
+            files = (node->hj_BatchFileNo == 0) ?
+                streamtable->unjoinedBatchFile : streamtable->joinedBatchFile;
+            if (files[curbatch] != NULL)
+            {
+                slot = ExecHashJoinGetSavedTuple(node, files[curbatch],
+                                                 &hashvalue, readslot);
+                if (!TupIsNull(slot))
+                    break;
+                /* keep the file if there are more chunks to stream it past */
+                if (node->hj_BuildFileNo == 2)
+                {
+                    ExecHashBatchFileClose(files[curbatch]);
+                    files[curbatch] = NULL;
+                }
+            }
+            node->hj_BatchFileNo++;
+        }
+
+        if (TupIsNull(slot))
+        {
+            /* stream the files again past the next chunk, if any */
+            if (node->hj_BuildFileNo < 2)
+            {
+                int         fileno;
+
+                for (fileno = 0; fileno < 2; fileno++)
+                {
+                    files = fileno ? streamtable->joinedBatchFile :
+                        streamtable->unjoinedBatchFile;
+                    if (files[curbatch] != NULL)
+                        ExecHashBatchFileRewind(files[curbatch]);
+                }
+                node->hj_BatchFileNo = 0;
+                ExecHashJoinLoadChunk(node);
+                continue;
+            }
+
+            /* this batch is done; on to the next one, if any */
+            if (!ExecHashJoinNewBatch(node))
+                return NULL;
+            continue;
+        }
+
+        node->hj_ProbeJoined = (node->hj_BatchFileNo == 1);
+
+        /*
+         * Loading the other side may have increased nbatch, in which case
+         * the tuple may belong to a later batch now; if so, save it there
+         * (the first time through the file only).
+         */
+        ExecHashGetBucketAndBatch(streamtable, hashvalue, &bucketno, &batchno);
+        if (batchno != curbatch)
+        {
+            if (node->hj_BatchChunks == 1)
+                ExecHashTableSaveTuple(streamtable, ExecFetchSlotTuple(slot),
+                                       hashvalue, batchno, node->hj_ProbeJoined);
+            continue;
+        }
+
+        node->hj_ProbeFetched = false;
+
+        /* the skew buckets only ever served the first pass */
+        if (node->hj_InFetched)
+        {
+            node->js.ps.ps_InnerTupleSlot = slot;
+            node->hj_InCurHashValue = hashvalue;
+            node->hj_OutCurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
+            node->hj_OutCurBucketNo = ExecHashBloomTest(buildtable, hashvalue) ?
+                bucketno : HJ_NO_BUCKET;
+            node->hj_OutCurTuple = NULL;
+        }
+        else
+        {
+            node->js.ps.ps_OuterTupleSlot = slot;
+            node->hj_OutCurHashValue = hashvalue;
+            node->hj_InCurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
+            node->hj_InCurBucketNo = ExecHashBloomTest(buildtable, hashvalue) ?
+                bucketno : HJ_NO_BUCKET;
+            node->hj_InCurTuple = NULL;
+        }
+    }
+}
+
+/*
+ * ExecHashJoinNewBatch
+ *		switch to a new hashjoin batch
+ *
+ * hashjoin_batch_order picks the next batch from the bytes each side has
+ * spilled to it:
+ *
+ *	HJ_BATCH_ORDER_LARGEST	the most data first, so the batches most likely
+ *							to need splitting again are out of the way early
+ *							and the quick ones come last
+ *	HJ_BATCH_ORDER_SMALLEST	the least data first, for the earliest output
+ *							and the smallest table while most files are
+ *							still on disk
+ *	HJ_BATCH_ORDER_MATCHES	the largest product of the two sides' sizes
+ *							first, i.e. the most expected join rows, taking
+ *							key values to be spread evenly over batches
+ *
+ * A batch can produce join rows only if one side has tuples not yet joined
+ * and the other side has any tuples at all; the files of any other batch are
+ * released (and so deleted) right away, and those of a joined batch as
+ * soon as they have been read for the last time.
+ *
+ * The side with less data in the batch is loaded into its table (see
+ * ExecHashJoinLoadChunk); the other side's files are rewound for
+ * ExecHashJoinBatches to stream.  Returns false if there are no more
+ * batches.
+ */
+static bool
+ExecHashJoinNewBatch(HashJoinState *hjstate)
+{
+    HashJoinTable inhashtable = hjstate->hj_InHashTable;
+    HashJoinTable outhashtable = hjstate->hj_OutHashTable;
+    HashJoinTable buildtable;
+    HashJoinTable streamtable;
+    int         nbatch = inhashtable->nbatch;
+    int         curbatch = -1;
+    double      curscore = 0;
+    int         fileno;
+    int         i;
+
+    for (i = 1; i < nbatch; i++)
+    {
+        HashJoinBatchFile innew = inhashtable->unjoinedBatchFile[i];
+        HashJoinBatchFile injoined = inhashtable->joinedBatchFile[i];
+        HashJoinBatchFile outnew = outhashtable->unjoinedBatchFile[i];
+        HashJoinBatchFile outjoined = outhashtable->joinedBatchFile[i];
+        double      inbytes = inhashtable->spillBytes[i];
+        double      outbytes = outhashtable->spillBytes[i];
+        double      score;
+
+        if ((innew != NULL && (outnew != NULL || outjoined != NULL)) ||
+            (outnew != NULL && injoined != NULL))
+        {
+            switch (hashjoin_batch_order)
+            {
+                case HJ_BATCH_ORDER_SMALLEST:
+                    score = -(inbytes + outbytes);
+                    break;
+                case HJ_BATCH_ORDER_MATCHES:
+                    score = inbytes * outbytes;
+                    break;
+                default:
+                    score = inbytes + outbytes;
+                    break;
+            }
+            if (curbatch < 0 || score > curscore)
+            {
+                curbatch = i;
+                curscore = score;
+            }
+            continue;
+        }
+
+        /* nothing in this batch can join */
+        if (innew != NULL)
+            ExecHashBatchFileClose(innew);
+        if (injoined != NULL)
+            ExecHashBatchFileClose(injoined);
+        if (outnew != NULL)
+            ExecHashBatchFileClose(outnew);
+        if (outjoined != NULL)
+            ExecHashBatchFileClose(outjoined);
+        inhashtable->unjoinedBatchFile[i] = NULL;
+        inhashtable->joinedBatchFile[i] = NULL;
+        outhashtable->unjoinedBatchFile[i] = NULL;
+        outhashtable->joinedBatchFile[i] = NULL;
+        inhashtable->spillBytes[i] = 0;
+        outhashtable->spillBytes[i] = 0;
+    }
+
+    if (curbatch < 0)
+        return false;
+
+    if (inhashtable->spillBytes[curbatch] <= outhashtable->spillBytes[curbatch])
+    {
+        buildtable = inhashtable;
+        streamtable = outhashtable;
+    }
+    else
+    {
+        buildtable = outhashtable;
+        streamtable = inhashtable;
+    }
+
+    ExecHashTableReset(inhashtable);
+    ExecHashTableReset(outhashtable);
+    inhashtable->curbatch = curbatch;
+    outhashtable->curbatch = curbatch;
+
+    /*
+     * Splitting the previous batch may have failed, but this one gets a
+     * fresh chance; see ExecHashIncreaseNumBatches.
+     */
+    inhashtable->growEnabled = true;
+    outhashtable->growEnabled = true;
+
+    /*
+     * Rewinding a file we have only written to so far also writes out its
+     * last block.
+     */
+    for (fileno = 0; fileno < 2; fileno++)
+    {
+        HashJoinBatchFile file;
+
+        file = fileno ? buildtable->joinedBatchFile[curbatch] :
+            buildtable->unjoinedBatchFile[curbatch];
+        if (file != NULL)
+            ExecHashBatchFileRewind(file);
+        file = fileno ? streamtable->joinedBatchFile[curbatch] :
+            streamtable->unjoinedBatchFile[curbatch];
+        if (file != NULL)
+            ExecHashBatchFileRewind(file);
+    }
+
+    /* tuples can only move to later batches, so these are done with */
+    inhashtable->spillBytes[curbatch] = 0;
+    outhashtable->spillBytes[curbatch] = 0;
+
+    hjstate->hj_InFetched = (streamtable == inhashtable);
+    hjstate->hj_BatchFileNo = 0;
+    hjstate->hj_BuildFileNo = 0;
+    hjstate->hj_BatchChunks = 0;
+    hjstate->js.ps.ps_InnerTupleSlot = NULL;
+    hjstate->js.ps.ps_OuterTupleSlot = NULL;
+    hjstate->hj_BatchesJoined++;
+
+    ExecHashJoinLoadChunk(hjstate);
+
+    return true;
+}
+
+/*
+ * ExecHashJoinLoadChunk
+ *		load the build side of the current batch into its table, or as much
+ *		of it as fits
+ *
+ * Tuples are reloaded with the marks they were saved with.  If the table
+ * fills up, ExecHashIncreaseNumBatches splits the batch with the next bit
+ * of the hash value, as in the first pass.  That can't separate tuples
+ * with identical hash values, though, so a batch dominated by one key may
+ * still not fit; then we stop loading when the table is full, and once the
+ * stream side has been joined with this chunk, ExecHashJoinBatches calls
+ * us again for the next one.  Each chunk thus costs one more pass over the
+ * stream side's files, but memory stays bounded however skewed the batch.
+ * hj_BuildFileNo is the build side file we're loading from (0 for its
+ * unjoinedBatchFile, 1 for its joinedBatchFile), or 2 once all is loaded.
+ */
+static void
+ExecHashJoinLoadChunk(HashJoinState *hjstate)
+{
+    HashJoinTable buildtable;
+    TupleTableSlot *buildslot;
+    int         curbatch;
+
+    if (hjstate->hj_InFetched)
+    {
+        buildtable = hjstate->hj_OutHashTable;
+        buildslot = hjstate->hj_OutHashTupleSlot;
+    }
+    else
+    {
+        buildtable = hjstate->hj_InHashTable;
+        buildslot = hjstate->hj_InHashTupleSlot;
+    }
+    curbatch = buildtable->curbatch;
+
+    if (hjstate->hj_BatchChunks > 0)
+    {
+        ExecHashTableReset(buildtable);
+        hjstate->hj_ExtraChunks++;
+    }
+    hjstate->hj_BatchChunks++;
+
+    while (hjstate->hj_BuildFileNo < 2)
+    {
+        HashJoinBatchFile *files = hjstate->hj_BuildFileNo ?
+            buildtable->joinedBatchFile : buildtable->unjoinedBatchFile;
+        TupleTableSlot *slot;
+        uint32      hashvalue;
+
+        if (files[curbatch] != NULL)
+        {
+            for (;;)
+            {
+                /* full, and splitting the batch didn't help? */
+                if (!buildtable->growEnabled &&
+                    buildtable->spaceUsed > buildtable->spaceAllowed)
+                    return;
+
+                slot = ExecHashJoinGetSavedTuple(hjstate, files[curbatch],
+                                                 &hashvalue, buildslot);
+                if (TupIsNull(slot))
+                    break;
+                ExecHashTableReload(buildtable, ExecFetchSlotTuple(slot),
+                                    hashvalue, hjstate->hj_BuildFileNo == 1);
+            }
+
+            ExecHashBatchFileClose(files[curbatch]);
+            files[curbatch] = NULL;
+        }
+        hjstate->hj_BuildFileNo++;
+    }
+}
+
+/*
+ * ExecHashJoinGetSavedTuple
+ *		read the next tuple from a batch file.	Return NULL if no more.
+ *
+ * On success, *hashvalue is set to the tuple's hash value, and the tuple
+ * itself is stored in the given slot.  It stays in the file's buffer, so
+ * the slot is only good until the next read from the same file.
+ */
+static TupleTableSlot *
+ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
+                          HashJoinBatchFile file,
+                          uint32 *hashvalue,
+                          TupleTableSlot *tupleSlot)
+{
+    HeapTuple	heapTuple;
+
+    heapTuple = ExecHashBatchFileRead(file, hashvalue);
+    if (heapTuple == NULL)
+        return NULL;			/* end of file */
+    return ExecStoreTuple(heapTuple, tupleSlot, InvalidBuffer, false);
+}
+
+
+void
+ExecReScanHashJoin(HashJoinState *node, ExprContext *exprCtxt)
+{
+    /*
+     * Rereading the inputs would put their rows into the saved state a
+     * second time, so a rescanned join starts its state over from scratch.
+     */
+    if (node->hj_SavedState != NULL)
+    {
+        ExecHashJoinReleaseState(node, false);
+        node->hj_InHashTable = NULL;
+        node->hj_OutHashTable = NULL;
+        if (((PlanState *) node)->righttree->chgParam == NULL)
+            ExecReScan(((PlanState *) node)->righttree, exprCtxt);
+    }
+
+    /*
+     * In a multi-batch join, we currently have to do rescans the hard way,
+     * primarily because batch temp files may have already been released. But
+     * if it's a single-batch join, and there is no parameter change for the
+     * inner subnode, then we can just re-use the existing hash table without
+     * rebuilding it.
+     */
+    if (node->hj_InHashTable!= NULL)
+    {
+        if (node->hj_InHashTable->nbatch == 1 &&
+            ((PlanState *) node)->righttree->chgParam == NULL)
+        {
+            /*
+             * okay to reuse the hash table; needn't rescan inner, either.
+             *
+             * What we do need to do is reset our state about the emptiness
+             * of the outer relation, so that the new scan of the outer will
+             * update it correctly if it turns out to be empty this time.
+             * (There's no harm in clearing it now because ExecHashJoin won't
+             * need the info.  In the other cases, where the hash table
+             * doesn't exist or we are destroying it, we leave this state
+             * alone because ExecHashJoin will need it the first time
+             * through.)
+             */
+            //CSI3130
+            //node->hj_OuterNotEmpty = false;
+        }
+        else
+        {
+            /* must destroy and rebuild hash table */
+            ExecHashTableDestroy(node->hj_InHashTable);
+            node->hj_InHashTable = NULL;
+
+            /*
+             * if chgParam of subnode is not null then plan will be re-scanned
+             * by first ExecProcNode.
+             */
+            if (((PlanState *) node)->righttree->chgParam == NULL)
+                ExecReScan(((PlanState *) node)->righttree, exprCtxt);
+        }
+    }
+
+    //CSI3130
+/*
+    */
+/* Always reset intra-tuple state *//*
+
+    node->hj_CurHashValue = 0;
+    node->hj_CurBucketNo = 0;
+    node->hj_CurTuple = NULL;
+*/
+
+    node->js.ps.ps_OuterTupleSlot = NULL;
+    node->js.ps.ps_TupFromTlist = false;
+    node->hj_NeedNewOuter = true;
+    node->hj_MatchedOuter = false;
+    node->hj_FirstOuterTupleSlot = NULL;
+
+    /*
+     * if chgParam of subnode is not null then plan will be re-scanned by
+     * first ExecProcNode.
+     */
+    if (((PlanState *) node)->lefttree->chgParam == NULL)
+        ExecReScan(((PlanState *) node)->lefttree, exprCtxt);
+}